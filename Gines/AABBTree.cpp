@@ -0,0 +1,427 @@
+#include "AABBTree.h"
+#include "CollisionBox.h"
+
+namespace gines
+{
+	AABBTree::AABBTree(float _margin) : margin(_margin)
+	{
+	}
+	AABBTree::~AABBTree()
+	{
+		clear();
+	}
+
+	unsigned AABBTree::allocateNode()
+	{
+		unsigned node;
+		if (freeList == UINT_MAX)
+		{
+			node = nodes.size();
+			nodes.push_back(Node());
+		}
+		else
+		{
+			node = freeList;
+			freeList = nodes[node].parent;
+		}
+		nodes[node].box = nullptr;
+		nodes[node].parent = UINT_MAX;
+		nodes[node].child1 = UINT_MAX;
+		nodes[node].child2 = UINT_MAX;
+		nodes[node].height = 0;
+		return node;
+	}
+	void AABBTree::freeNode(unsigned node)
+	{
+		nodes[node].box = nullptr;
+		nodes[node].height = -1;
+		nodes[node].parent = freeList;
+		freeList = node;
+	}
+	bool AABBTree::isProxyOf(unsigned proxy, CollisionBox* box)
+	{
+		return proxy < nodes.size() && nodes[proxy].height == 0 && nodes[proxy].box == box;
+	}
+
+	void AABBTree::insert(CollisionBox* box)
+	{
+		unsigned leaf = allocateNode();
+		nodes[leaf].box = box;
+		nodes[leaf].layers = box->getLayers();
+		nodes[leaf].mask = box->getMask();
+		nodes[leaf].tight = box->getBounds();
+		nodes[leaf].bounds = nodes[leaf].tight.expanded(margin);
+		insertLeaf(leaf);
+		box->setProxy(leaf);
+		leafCount++;
+	}
+	void AABBTree::remove(CollisionBox* box)
+	{
+		unsigned leaf = box->getProxy();
+		if (!isProxyOf(leaf, box))
+			return;
+		removeLeaf(leaf);
+		freeNode(leaf);
+		box->setProxy(UINT_MAX);
+		leafCount--;
+	}
+	void AABBTree::update(CollisionBox* box)
+	{
+		unsigned leaf = box->getProxy();
+		if (!isProxyOf(leaf, box))
+			return;
+		Node& node = nodes[leaf];
+		node.layers = box->getLayers();
+		node.mask = box->getMask();
+		node.tight = box->getBounds();
+		//Small movements stay inside the fattened bounds. Boxes that shrank a lot are reinserted to keep the bounds tight
+		if (node.bounds.contains(node.tight) && node.tight.expanded(2.0f * margin).contains(node.bounds))
+			return;
+		removeLeaf(leaf);
+		nodes[leaf].bounds = nodes[leaf].tight.expanded(margin);
+		insertLeaf(leaf);
+	}
+	void AABBTree::clear()
+	{
+		for (unsigned i = 0; i < nodes.size(); i++)
+		{
+			if (nodes[i].height == 0 && nodes[i].box != nullptr)
+				nodes[i].box->setProxy(UINT_MAX);
+		}
+		nodes.clear();
+		root = UINT_MAX;
+		freeList = UINT_MAX;
+		leafCount = 0;
+	}
+
+	void AABBTree::insertLeaf(unsigned leaf)
+	{
+		if (root == UINT_MAX)
+		{
+			root = leaf;
+			nodes[leaf].parent = UINT_MAX;
+			return;
+		}
+
+		//Find the sibling that grows the total perimeter the least
+		const AABB leafBounds = nodes[leaf].bounds;
+		unsigned index = root;
+		while (!nodes[index].isLeaf())
+		{
+			const Node& node = nodes[index];
+			const float perimeter = node.bounds.perimeter();
+			const float combinedPerimeter = node.bounds.merged(leafBounds).perimeter();
+			//Cost of pairing with this node, and of pushing the leaf further down
+			const float cost = 2.0f * combinedPerimeter;
+			const float inheritanceCost = 2.0f * (combinedPerimeter - perimeter);
+
+			const Node& child1 = nodes[node.child1];
+			float cost1 = leafBounds.merged(child1.bounds).perimeter() + inheritanceCost;
+			if (!child1.isLeaf())
+				cost1 -= child1.bounds.perimeter();
+			const Node& child2 = nodes[node.child2];
+			float cost2 = leafBounds.merged(child2.bounds).perimeter() + inheritanceCost;
+			if (!child2.isLeaf())
+				cost2 -= child2.bounds.perimeter();
+
+			if (cost < cost1 && cost < cost2)
+				break;
+			index = cost1 < cost2 ? node.child1 : node.child2;
+		}
+
+		//New parent for the sibling and the leaf
+		const unsigned sibling = index;
+		const unsigned oldParent = nodes[sibling].parent;
+		const unsigned newParent = allocateNode();
+		nodes[newParent].parent = oldParent;
+		nodes[newParent].bounds = leafBounds.merged(nodes[sibling].bounds);
+		nodes[newParent].height = nodes[sibling].height + 1;
+		nodes[newParent].child1 = sibling;
+		nodes[newParent].child2 = leaf;
+		nodes[sibling].parent = newParent;
+		nodes[leaf].parent = newParent;
+		if (oldParent == UINT_MAX)
+			root = newParent;
+		else if (nodes[oldParent].child1 == sibling)
+			nodes[oldParent].child1 = newParent;
+		else
+			nodes[oldParent].child2 = newParent;
+
+		//Walk back up fixing heights and bounds
+		index = nodes[leaf].parent;
+		while (index != UINT_MAX)
+		{
+			index = balance(index);
+			refit(index);
+			index = nodes[index].parent;
+		}
+	}
+	void AABBTree::removeLeaf(unsigned leaf)
+	{
+		if (leaf == root)
+		{
+			root = UINT_MAX;
+			return;
+		}
+
+		const unsigned parent = nodes[leaf].parent;
+		const unsigned grandParent = nodes[parent].parent;
+		const unsigned sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+		freeNode(parent);
+		if (grandParent == UINT_MAX)
+		{
+			root = sibling;
+			nodes[sibling].parent = UINT_MAX;
+			return;
+		}
+
+		//The sibling takes the parent's place
+		if (nodes[grandParent].child1 == parent)
+			nodes[grandParent].child1 = sibling;
+		else
+			nodes[grandParent].child2 = sibling;
+		nodes[sibling].parent = grandParent;
+
+		unsigned index = grandParent;
+		while (index != UINT_MAX)
+		{
+			index = balance(index);
+			refit(index);
+			index = nodes[index].parent;
+		}
+	}
+	void AABBTree::refit(unsigned node)
+	{
+		const Node& child1 = nodes[nodes[node].child1];
+		const Node& child2 = nodes[nodes[node].child2];
+		nodes[node].height = 1 + (child1.height > child2.height ? child1.height : child2.height);
+		nodes[node].bounds = child1.bounds.merged(child2.bounds);
+	}
+	unsigned AABBTree::balance(unsigned iA)
+	{
+		//Rotates the taller grandchild of A up when the children of A differ in height by more than one
+		Node& A = nodes[iA];
+		if (A.isLeaf() || A.height < 2)
+			return iA;
+
+		const unsigned iB = A.child1;
+		const unsigned iC = A.child2;
+		Node& B = nodes[iB];
+		Node& C = nodes[iC];
+		const int difference = C.height - B.height;
+
+		if (difference > 1)
+		{//C goes up
+			const unsigned iF = C.child1;
+			const unsigned iG = C.child2;
+			Node& F = nodes[iF];
+			Node& G = nodes[iG];
+
+			C.child1 = iA;
+			C.parent = A.parent;
+			A.parent = iC;
+			if (C.parent == UINT_MAX)
+				root = iC;
+			else if (nodes[C.parent].child1 == iA)
+				nodes[C.parent].child1 = iC;
+			else
+				nodes[C.parent].child2 = iC;
+
+			//The taller of F and G stays under C
+			if (F.height > G.height)
+			{
+				C.child2 = iF;
+				A.child2 = iG;
+				G.parent = iA;
+			}
+			else
+			{
+				C.child2 = iG;
+				A.child2 = iF;
+				F.parent = iA;
+			}
+			refit(iA);
+			refit(iC);
+			return iC;
+		}
+		if (difference < -1)
+		{//B goes up
+			const unsigned iD = B.child1;
+			const unsigned iE = B.child2;
+			Node& D = nodes[iD];
+			Node& E = nodes[iE];
+
+			B.child1 = iA;
+			B.parent = A.parent;
+			A.parent = iB;
+			if (B.parent == UINT_MAX)
+				root = iB;
+			else if (nodes[B.parent].child1 == iA)
+				nodes[B.parent].child1 = iB;
+			else
+				nodes[B.parent].child2 = iB;
+
+			if (D.height > E.height)
+			{
+				B.child2 = iD;
+				A.child1 = iE;
+				E.parent = iA;
+			}
+			else
+			{
+				B.child2 = iE;
+				A.child1 = iD;
+				D.parent = iA;
+			}
+			refit(iA);
+			refit(iB);
+			return iB;
+		}
+		return iA;
+	}
+
+	void AABBTree::queryPairs(std::vector<CollisionPair>& pairs)
+	{
+		//Descends into both sides of every internal node at once, so each pair of subtrees is visited once
+		if (root == UINT_MAX || nodes[root].isLeaf())
+			return;
+		pairStack.clear();
+		pairStack.push_back(NodePair(nodes[root].child1, nodes[root].child2));
+		stack.clear();
+		stack.push_back(nodes[root].child1);
+		stack.push_back(nodes[root].child2);
+		while (!stack.empty())
+		{//Pairs within each subtree
+			const Node& node = nodes[stack.back()];
+			stack.pop_back();
+			if (node.isLeaf())
+				continue;
+			pairStack.push_back(NodePair(node.child1, node.child2));
+			stack.push_back(node.child1);
+			stack.push_back(node.child2);
+		}
+
+		while (!pairStack.empty())
+		{
+			const NodePair pair = pairStack.back();
+			pairStack.pop_back();
+			const Node& a = nodes[pair.a];
+			const Node& b = nodes[pair.b];
+			if (!a.bounds.overlaps(b.bounds))
+				continue;
+			if (a.isLeaf() && b.isLeaf())
+			{
+				if (Broadphase::canCollide(a.layers, a.mask, b.layers, b.mask) && a.tight.overlaps(b.tight))
+					pairs.push_back(CollisionPair(a.box, b.box));
+			}
+			else if (b.isLeaf() || (!a.isLeaf() && a.bounds.perimeter() > b.bounds.perimeter()))
+			{//Split the larger node
+				pairStack.push_back(NodePair(a.child1, pair.b));
+				pairStack.push_back(NodePair(a.child2, pair.b));
+			}
+			else
+			{
+				pairStack.push_back(NodePair(pair.a, b.child1));
+				pairStack.push_back(NodePair(pair.a, b.child2));
+			}
+		}
+	}
+	void AABBTree::queryRect(const AABB& rect, std::vector<CollisionBox*>& results, unsigned layers)
+	{
+		if (root == UINT_MAX)
+			return;
+		stack.clear();
+		stack.push_back(root);
+		while (!stack.empty())
+		{
+			const Node& node = nodes[stack.back()];
+			stack.pop_back();
+			if (!node.bounds.overlaps(rect))
+				continue;
+			if (node.isLeaf())
+			{
+				if ((node.layers & layers) != 0 && node.tight.overlaps(rect))
+					results.push_back(node.box);
+			}
+			else
+			{
+				stack.push_back(node.child1);
+				stack.push_back(node.child2);
+			}
+		}
+	}
+	void AABBTree::queryPoint(glm::vec2 point, std::vector<CollisionBox*>& results, unsigned layers)
+	{
+		if (root == UINT_MAX)
+			return;
+		stack.clear();
+		stack.push_back(root);
+		while (!stack.empty())
+		{
+			const Node& node = nodes[stack.back()];
+			stack.pop_back();
+			if (!node.bounds.contains(point))
+				continue;
+			if (node.isLeaf())
+			{
+				if ((node.layers & layers) != 0 && node.tight.contains(point))
+					results.push_back(node.box);
+			}
+			else
+			{
+				stack.push_back(node.child1);
+				stack.push_back(node.child2);
+			}
+		}
+	}
+	void AABBTree::queryRay(glm::vec2 from, glm::vec2 to, std::vector<RayHit>& hits, unsigned layers)
+	{
+		if (root == UINT_MAX)
+			return;
+		stack.clear();
+		stack.push_back(root);
+		float fraction;
+		while (!stack.empty())
+		{
+			const Node& node = nodes[stack.back()];
+			stack.pop_back();
+			if (!node.bounds.intersectsSegment(from, to, fraction))
+				continue;
+			if (node.isLeaf())
+			{
+				if ((node.layers & layers) != 0 && node.tight.intersectsSegment(from, to, fraction))
+					hits.push_back(RayHit(node.box, fraction));
+			}
+			else
+			{
+				stack.push_back(node.child1);
+				stack.push_back(node.child2);
+			}
+		}
+	}
+	void AABBTree::querySweep(const AABB& box, glm::vec2 displacement, std::vector<RayHit>& hits, unsigned layers)
+	{
+		if (root == UINT_MAX)
+			return;
+		stack.clear();
+		stack.push_back(root);
+		float fraction;
+		while (!stack.empty())
+		{
+			const Node& node = nodes[stack.back()];
+			stack.pop_back();
+			if (!node.bounds.sweep(box, displacement, fraction))
+				continue;
+			if (node.isLeaf())
+			{
+				if ((node.layers & layers) != 0 && node.tight.sweep(box, displacement, fraction))
+					hits.push_back(RayHit(node.box, fraction));
+			}
+			else
+			{
+				stack.push_back(node.child1);
+				stack.push_back(node.child2);
+			}
+		}
+	}
+}
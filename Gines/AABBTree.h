@@ -0,0 +1,70 @@
+#pragma once
+
+#include <vector>
+#include <climits>
+#include "Broadphase.h"
+
+#define GINES_AABB_TREE_MARGIN 4.0f	//How far leaf bounds are fattened, in world units
+
+namespace gines
+{
+	/*Dynamic bounding volume tree broadphase.
+	Leaves store bounds fattened by the margin, so a box that moves less than that is not reinserted.
+	The tree is kept balanced with rotations. Nodes live in one array and are referred to by index*/
+	class AABBTree : public Broadphase
+	{
+	public:
+		AABBTree(float margin = GINES_AABB_TREE_MARGIN);
+		~AABBTree();
+
+		void insert(CollisionBox* box);
+		void remove(CollisionBox* box);
+		void update(CollisionBox* box);
+		void clear();
+
+		void queryPairs(std::vector<CollisionPair>& pairs);
+		void queryRect(const AABB& rect, std::vector<CollisionBox*>& results, unsigned layers = GINES_ALL_LAYERS);
+		void queryPoint(glm::vec2 point, std::vector<CollisionBox*>& results, unsigned layers = GINES_ALL_LAYERS);
+		void queryRay(glm::vec2 from, glm::vec2 to, std::vector<RayHit>& hits, unsigned layers = GINES_ALL_LAYERS);
+		void querySweep(const AABB& box, glm::vec2 displacement, std::vector<RayHit>& hits, unsigned layers = GINES_ALL_LAYERS);
+
+		unsigned getHeight(){ return root == UINT_MAX ? 0 : nodes[root].height; }
+		unsigned getLeafCount(){ return leafCount; }
+
+	private:
+		struct Node
+		{
+			AABB bounds;//Fattened for leaves
+			AABB tight;//Exact bounds of the box, leaves only
+			CollisionBox* box;//Leaves only
+			unsigned layers;//Leaves only, copied from the box
+			unsigned mask;
+			unsigned parent;//Next free node when the node is free
+			unsigned child1;
+			unsigned child2;
+			int height;//0 for leaves, -1 for free nodes
+			bool isLeaf() const { return child1 == UINT_MAX; }
+		};
+		unsigned allocateNode();
+		void freeNode(unsigned node);
+		void insertLeaf(unsigned leaf);
+		void removeLeaf(unsigned leaf);
+		unsigned balance(unsigned node);
+		void refit(unsigned node);//Recomputes the bounds and height of node from its children
+		bool isProxyOf(unsigned proxy, CollisionBox* box);
+
+		float margin;
+		std::vector<Node> nodes;
+		unsigned root = UINT_MAX;
+		unsigned freeList = UINT_MAX;
+		unsigned leafCount = 0;
+		struct NodePair
+		{
+			NodePair(unsigned _a, unsigned _b) : a(_a), b(_b){}
+			unsigned a;
+			unsigned b;
+		};
+		std::vector<unsigned> stack;//Traversal stacks, reused between queries
+		std::vector<NodePair> pairStack;
+	};
+}
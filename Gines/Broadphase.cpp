@@ -0,0 +1,71 @@
+#include "Broadphase.h"
+#include "SpatialHash.h"
+#include "CollisionBox.h"
+
+namespace gines
+{
+	void Broadphase::queryRay(glm::vec2 from, glm::vec2 to, std::vector<RayHit>& hits, unsigned layers)
+	{
+		std::vector<CollisionBox*> boxes;
+		AABB rect(glm::vec2(from.x < to.x ? from.x : to.x, from.y < to.y ? from.y : to.y),
+			glm::vec2(from.x > to.x ? from.x : to.x, from.y > to.y ? from.y : to.y));
+		queryRect(rect, boxes, layers);
+		for (unsigned i = 0; i < boxes.size(); i++)
+		{
+			float fraction;
+			if (boxes[i]->getBounds().intersectsSegment(from, to, fraction))
+				hits.push_back(RayHit(boxes[i], fraction));
+		}
+	}
+	void Broadphase::querySweep(const AABB& box, glm::vec2 displacement, std::vector<RayHit>& hits, unsigned layers)
+	{
+		std::vector<CollisionBox*> boxes;
+		queryRect(box.merged(AABB(box.min + displacement, box.max + displacement)), boxes, layers);
+		for (unsigned i = 0; i < boxes.size(); i++)
+		{
+			float fraction;
+			if (boxes[i]->getBounds().sweep(box, displacement, fraction))
+				hits.push_back(RayHit(boxes[i], fraction));
+		}
+	}
+
+	//The default broadphase outlives every collision box, including static ones
+	static Broadphase* getDefaultBroadphase()
+	{
+		static SpatialHash* spatialHash = new SpatialHash();
+		return spatialHash;
+	}
+	static Broadphase* activeBroadphase = nullptr;
+
+	void setBroadphase(Broadphase* broadphase)
+	{
+		if (broadphase == nullptr)
+			broadphase = getDefaultBroadphase();
+		Broadphase* previous = getBroadphase();
+		if (broadphase == previous)
+			return;
+		previous->clear();
+		activeBroadphase = broadphase;
+		broadphase->clear();
+		for (unsigned i = 0; i < collisionBoxes.size(); i++)
+		{
+			collisionBoxes[i]->checkMoved();
+			broadphase->insert(collisionBoxes[i]);
+		}
+	}
+	Broadphase* getBroadphase()
+	{
+		if (activeBroadphase == nullptr)
+			activeBroadphase = getDefaultBroadphase();
+		return activeBroadphase;
+	}
+	void updateBroadphase()
+	{
+		Broadphase* broadphase = getBroadphase();
+		for (unsigned i = 0; i < collisionBoxes.size(); i++)
+		{
+			if (collisionBoxes[i]->checkMoved())
+				broadphase->update(collisionBoxes[i]);
+		}
+	}
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <vector>
+#include <glm/vec2.hpp>
+#include "Geometry.h"
+
+#define GINES_ALL_LAYERS 0xffffffff	//Layer bits of every layer
+
+/*
+Broadphase finds the collision boxes whose bounds overlap without testing every pair.
+All collision boxes are kept in the active broadphase, a SpatialHash by default.
+AABBTree handles scenes where box sizes vary a lot better:
+
+	gines::AABBTree tree;//Must outlive its use, or be swapped out first with setBroadphase(nullptr)
+	gines::setBroadphase(&tree);
+	std::vector<gines::CollisionPair> pairs;
+	gines::getBroadphase()->queryPairs(pairs);
+	for (auto& pair : pairs)
+		if (pair.a->isColliding(*pair.b)) ...
+
+Pairs only include boxes whose layers are in each other's masks, see CollisionBox::setLayers.
+Boxes that moved are updated by updateBroadphase(), which beginMainLoop() calls.
+Call it again before querying if boxes were moved earlier in the same frame.
+*/
+namespace gines
+{
+	class CollisionBox;
+	struct CollisionPair
+	{
+		CollisionPair() : a(nullptr), b(nullptr){}
+		CollisionPair(CollisionBox* _a, CollisionBox* _b) : a(_a), b(_b){}
+		CollisionBox* a;
+		CollisionBox* b;
+	};
+	struct RayHit
+	{
+		RayHit() : box(nullptr), fraction(0.0f){}
+		RayHit(CollisionBox* _box, float _fraction) : box(_box), fraction(_fraction){}
+		CollisionBox* box;
+		float fraction;//Where the segment enters the box, 0 at the start and 1 at the end
+	};
+
+	class Broadphase
+	{
+	public:
+		virtual ~Broadphase(){}
+		virtual void insert(CollisionBox* box) = 0;
+		virtual void remove(CollisionBox* box) = 0;
+		virtual void update(CollisionBox* box) = 0;//Box bounds have changed
+		virtual void clear() = 0;//Removes all boxes
+
+		//Layer test done on the copies of the bits that the broadphases keep
+		static bool canCollide(unsigned layersA, unsigned maskA, unsigned layersB, unsigned maskB){ return (layersA & maskB) != 0 && (layersB & maskA) != 0; }
+
+		//Results are appended
+		virtual void queryPairs(std::vector<CollisionPair>& pairs) = 0;//Each overlapping pair that can collide once
+		//Only boxes on at least one of the given layers are returned
+		virtual void queryRect(const AABB& rect, std::vector<CollisionBox*>& results, unsigned layers = GINES_ALL_LAYERS) = 0;
+		virtual void queryPoint(glm::vec2 point, std::vector<CollisionBox*>& results, unsigned layers = GINES_ALL_LAYERS) = 0;
+		//Boxes crossed by the segment from -> to, in no particular order. The default tests the boxes in the segment's bounding rect
+		virtual void queryRay(glm::vec2 from, glm::vec2 to, std::vector<RayHit>& hits, unsigned layers = GINES_ALL_LAYERS);
+		//Boxes that box hits when moved by displacement, with the fraction of the move where it first touches them. See AABB::sweep
+		virtual void querySweep(const AABB& box, glm::vec2 displacement, std::vector<RayHit>& hits, unsigned layers = GINES_ALL_LAYERS);
+	};
+
+	/*Makes broadphase the active one and moves every collision box into it.
+	The broadphase is owned by the caller, passing nullptr goes back to the default spatial hash*/
+	void setBroadphase(Broadphase* broadphase);
+	Broadphase* getBroadphase();
+	//Updates the boxes that moved or whose transforms moved since the last call
+	void updateBroadphase();
+}
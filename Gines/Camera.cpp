@@ -10,11 +10,21 @@ namespace gines
 	std::vector<gines::Camera*> cameras;
 	gines::Camera guiCamera;
 
-	Camera::Camera() : enabled(true), doMatrixUpdate(true), scale(1), orthoMatrix(1.0f), cameraMatrix(1.0f), gameObjectPosition(0, 0), viewportPosition(0), viewportSize(0)
+	Camera::Camera() : enabled(true), doMatrixUpdate(true), scale(1), orthoMatrix(1.0f), cameraMatrix(1.0f), gameObjectPosition(0, 0), transformVersion(0), viewportPosition(0), viewportSize(0)
+	{
+		cameras.push_back(this);
+	}
+	Camera::Camera(const Camera& original) : Component(original), enabled(original.enabled), doMatrixUpdate(true), scale(original.scale),
+		orthoMatrix(original.orthoMatrix), cameraMatrix(original.cameraMatrix), gameObjectPosition(0, 0), transformVersion(0),
+		viewportPosition(original.viewportPosition), viewportSize(original.viewportSize), position(original.position)
 	{
 		cameras.push_back(this);
 	}
 	Camera::~Camera()
+	{
+		onPrefabPrototype();
+	}
+	void Camera::onPrefabPrototype()
 	{
 		for (unsigned i = 0; i < cameras.size(); i++)
 		{
@@ -37,9 +47,11 @@ namespace gines
 	{
 		if (gameObject != nullptr)
 		{
-			if (gameObjectPosition != gameObject->transform().getPosition())
+			unsigned version = gameObject->transform().getWorldVersion();
+			if (transformVersion != version)
 			{
-				gameObjectPosition = gameObject->transform().getPosition();
+				transformVersion = version;
+				gameObjectPosition = gameObject->transform().getWorldPosition();
 				doMatrixUpdate = true;
 			}
 		}
@@ -51,8 +63,8 @@ namespace gines
 		glm::vec3 translate;
 		if (gameObject != nullptr)
 		{//Game object exists
-			translate.x = -position.x - gameObject->transform().getPosition().x + viewportSize.x*0.5f / (viewportSize.x / WINDOW_WIDTH);
-			translate.y = -position.y -gameObject->transform().getPosition().y + viewportSize.y*0.5f/ (viewportSize.y / WINDOW_HEIGHT), 0.0f;
+			translate.x = -position.x - gameObjectPosition.x + viewportSize.x*0.5f / (viewportSize.x / WINDOW_WIDTH);
+			translate.y = -position.y - gameObjectPosition.y + viewportSize.y*0.5f/ (viewportSize.y / WINDOW_HEIGHT), 0.0f;
 		}
 		else
 		{//No game object
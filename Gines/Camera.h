@@ -11,9 +11,12 @@ namespace gines
 	{
 	public:
 		Camera();
+		Camera(const Camera& original);
 		~Camera();
+		void onPrefabPrototype();//Leaves the cameras vector
 
 		void update();
+		bool isThreadSafe(){ return false; }//Reads the world transform, which depends on the parent transforms
 
 		void setScale(float);
 		void setViewport(glm::vec2& bottomLeftPosition, glm::vec2& size);
@@ -34,7 +37,8 @@ namespace gines
 		float scale;
 		glm::mat4 orthoMatrix;
 		glm::mat4 cameraMatrix;
-		glm::vec2 gameObjectPosition;//Game object position tracking
+		glm::vec2 gameObjectPosition;//World position of the game object
+		unsigned transformVersion;//World transform version that gameObjectPosition was read from
 		glm::vec2 viewportPosition;
 		glm::vec2 viewportSize;
 		glm::vec2 position;//Cameras position relative to game object
@@ -0,0 +1,125 @@
+#include <SDL\SDL_timer.h>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+
+#include "CollisionBenchmark.h"
+#include "Gines.h"
+#include "CollisionBox.h"
+#include "SpatialHash.h"
+#include "AABBTree.h"
+#include "SweepAndPrune.h"
+
+#define GINES_BENCHMARK_BRUTE_FORCE_LIMIT 20000
+#define BENCHMARK_SEED 1234
+#define BENCHMARK_JITTER 2	//Max movement of the extra boxes per frame, world units
+
+namespace gines
+{
+	static double elapsedMs(Uint64 start)
+	{
+		return double(SDL_GetPerformanceCounter() - start) * 1000.0 / double(SDL_GetPerformanceFrequency());
+	}
+	static void bruteForcePairs(std::vector<CollisionPair>& pairs)
+	{
+		std::vector<AABB> bounds(collisionBoxes.size());
+		for (unsigned i = 0; i < collisionBoxes.size(); i++)
+			bounds[i] = collisionBoxes[i]->getBounds();
+		for (unsigned i = 0; i < bounds.size(); i++)
+		{
+			for (unsigned j = i + 1; j < bounds.size(); j++)
+			{
+				if (collisionBoxes[i]->canCollide(*collisionBoxes[j]) && bounds[i].overlaps(bounds[j]))
+					pairs.push_back(CollisionPair(collisionBoxes[i], collisionBoxes[j]));
+			}
+		}
+	}
+
+	void runCollisionBenchmark(unsigned extraBoxes, unsigned frames, std::vector<CollisionBenchmarkResult>& results)
+	{
+		if (frames == 0)
+			frames = 1;
+		Broadphase* previous = getBroadphase();
+
+		//Extra boxes, about one per 40x40 area
+		std::srand(BENCHMARK_SEED);
+		const int side = int(std::sqrt(float(extraBoxes))) * 40 + 1;
+		std::vector<CollisionBox*> extra(extraBoxes);
+		std::vector<float> startX(extraBoxes), startY(extraBoxes);
+		for (unsigned i = 0; i < extraBoxes; i++)
+		{
+			extra[i] = new CollisionBox();
+			extra[i]->setSize(float(2 + std::rand() % 40), float(2 + std::rand() % 40));
+			startX[i] = float(std::rand() % side);
+			startY[i] = float(std::rand() % side);
+		}
+
+		SpatialHash spatialHash;
+		AABBTree tree;
+		SweepAndPrune sweepAndPrune;
+		Broadphase* candidates[] = { nullptr, &spatialHash, &tree, &sweepAndPrune };
+		const char* names[] = { "brute force", "spatial hash", "aabb tree", "sweep and prune" };
+		std::vector<CollisionPair> pairs;
+		for (unsigned c = 0; c < 4; c++)
+		{
+			if (candidates[c] == nullptr && collisionBoxes.size() > GINES_BENCHMARK_BRUTE_FORCE_LIMIT)
+				continue;
+			//Every candidate sees the same movement
+			std::srand(BENCHMARK_SEED);
+			for (unsigned i = 0; i < extraBoxes; i++)
+				extra[i]->setPosition(startX[i], startY[i]);
+
+			CollisionBenchmarkResult result;
+			result.name = names[c];
+			Uint64 start = SDL_GetPerformanceCounter();
+			if (candidates[c] != nullptr)
+				setBroadphase(candidates[c]);
+			result.buildMs = elapsedMs(start);
+
+			for (unsigned frame = 0; frame < frames; frame++)
+			{
+				for (unsigned i = 0; i < extraBoxes; i++)
+					extra[i]->move(float(std::rand() % (2 * BENCHMARK_JITTER + 1) - BENCHMARK_JITTER), float(std::rand() % (2 * BENCHMARK_JITTER + 1) - BENCHMARK_JITTER));
+
+				start = SDL_GetPerformanceCounter();
+				if (candidates[c] != nullptr)
+					updateBroadphase();
+				result.updateMs += elapsedMs(start);
+
+				pairs.clear();
+				start = SDL_GetPerformanceCounter();
+				if (candidates[c] != nullptr)
+					candidates[c]->queryPairs(pairs);
+				else
+					bruteForcePairs(pairs);
+				result.queryMs += elapsedMs(start);
+			}
+			result.updateMs /= frames;
+			result.queryMs /= frames;
+			result.pairs = pairs.size();
+			results.push_back(result);
+		}
+
+		setBroadphase(previous);
+		for (unsigned i = 0; i < extraBoxes; i++)
+			delete extra[i];
+	}
+
+	static void collisionBenchCommand(std::vector<std::string>& words)
+	{
+		unsigned extraBoxes = words.size() > 1 ? unsigned(atoi(words[1].c_str())) : 10000;
+		unsigned frames = words.size() > 2 ? unsigned(atoi(words[2].c_str())) : 10;
+		std::vector<CollisionBenchmarkResult> results;
+		runCollisionBenchmark(extraBoxes, frames, results);
+		console.log(std::to_string(collisionBoxes.size() + extraBoxes) + " boxes, " + std::to_string(frames) + " frames");
+		for (unsigned i = 0; i < results.size(); i++)
+		{
+			console.log(results[i].name + ": build " + std::to_string(results[i].buildMs) + " ms, update " + std::to_string(results[i].updateMs) +
+				" ms, pairs " + std::to_string(results[i].queryMs) + " ms, " + std::to_string(results[i].pairs) + " pairs");
+		}
+	}
+	void addCollisionBenchmarkCommand()
+	{
+		console.addConsoleCommand("collisionbench", collisionBenchCommand);
+	}
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <vector>
+#include <string>
+
+/*
+Compares the broadphases on the current collision boxes plus optional random extra boxes.
+From the console: collisionbench [extra boxes] [frames]
+*/
+namespace gines
+{
+	struct CollisionBenchmarkResult
+	{
+		std::string name;
+		double buildMs = 0.0;	//Inserting every box
+		double updateMs = 0.0;	//Average per frame
+		double queryMs = 0.0;	//Average queryPairs time per frame
+		unsigned pairs = 0;		//Pairs found on the last frame
+	};
+
+	/*Extra boxes are spread randomly and jittered every frame, the existing boxes stay where they are.
+	Brute force is left out above GINES_BENCHMARK_BRUTE_FORCE_LIMIT boxes*/
+	void runCollisionBenchmark(unsigned extraBoxes, unsigned frames, std::vector<CollisionBenchmarkResult>& results);
+	void addCollisionBenchmarkCommand();
+}
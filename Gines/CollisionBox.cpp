@@ -1,55 +1,136 @@
 #include <vector>
 #include "CollisionBox.h"
 #include "Gameobject.h"
+#include "Broadphase.h"
+#include "Transform.h"
+#include "ContactEvents.h"
+#include <cmath>
 
 namespace gines
 {
 	std::vector<CollisionBox*> collisionBoxes;
+	std::vector<CollisionBox*> bulletBoxes;
 	CollisionBox::CollisionBox() : size(0, 0), position(0, 0), origin(0)
 	{
 		//Push to collision boxes vector
+		registryIndex = collisionBoxes.size();
 		collisionBoxes.push_back(this);
+		getBroadphase()->insert(this);
+	}
+	CollisionBox::CollisionBox(const CollisionBox& original) : Component(original), size(original.size), position(original.position), origin(original.origin),
+		layers(original.layers), mask(original.mask)
+	{
+		registryIndex = collisionBoxes.size();
+		collisionBoxes.push_back(this);
+		getBroadphase()->insert(this);
+		if (original.bullet)
+			setBullet(true);
 	}
 	CollisionBox::~CollisionBox()
 	{
-		//Remove from collision boxes vector
-		for (unsigned i = 0; i < collisionBoxes.size(); i++)
+		setBullet(false);
+		removeContacts(this);
+		getBroadphase()->remove(this);
+		unregister();
+	}
+	void CollisionBox::onPrefabPrototype()
+	{
+		removeContacts(this);
+		getBroadphase()->remove(this);
+		unregister();
+		setBullet(bullet);//Leaves bulletBoxes, the flag stays for the copies
+	}
+	void CollisionBox::unregister()
+	{
+		if (registryIndex == UINT_MAX)
+			return;
+		//Remove from collision boxes vector, swap and pop
+		collisionBoxes[registryIndex] = collisionBoxes.back();
+		collisionBoxes[registryIndex]->registryIndex = registryIndex;
+		collisionBoxes.pop_back();
+		registryIndex = UINT_MAX;
+	}
+	void CollisionBox::setBullet(bool enabled)
+	{
+		bullet = enabled;
+		const bool listed = enabled && registryIndex != UINT_MAX;
+		if (listed == (bulletIndex != UINT_MAX))
+			return;
+		if (listed)
 		{
-			if (collisionBoxes[i] == this)
+			bulletIndex = bulletBoxes.size();
+			bulletBoxes.push_back(this);
+		}
+		else
+		{//Swap and pop
+			bulletBoxes[bulletIndex] = bulletBoxes.back();
+			bulletBoxes[bulletIndex]->bulletIndex = bulletIndex;
+			bulletBoxes.pop_back();
+			bulletIndex = UINT_MAX;
+		}
+	}
+	const OrientedBox& CollisionBox::getOrientedBox()
+	{
+		Transform* transform = nullptr;
+		if (gameObject != nullptr && gameObject->hasTransform())
+		{
+			transform = &gameObject->transform();
+			if (transform->getWorldVersion() != orientedVersion)
+				orientedDirty = true;
+		}
+		if (!orientedDirty)
+			return orientedBox;
+		orientedDirty = false;
+
+		glm::vec2 pivot = position;
+		float rotation = 0.0f;
+		if (transform != nullptr)
+		{
+			orientedVersion = transform->getWorldVersion();
+			pivot += transform->getWorldPosition();
+			rotation = transform->getWorldRotation();
+		}
+		orientedBox.halfSize = size * 0.5f;
+		glm::vec2 offset = orientedBox.halfSize - origin;//Pivot to center, unrotated
+		if (rotation == 0.0f)
+		{
+			orientedBox.axis = glm::vec2(1.0f, 0.0f);
+			orientedBox.center = pivot + offset;
+		}
+		else
+		{
+			orientedBox.axis = glm::vec2(cosf(rotation), sinf(rotation));
+			orientedBox.center = pivot + rotatePoint(offset, rotation);
+		}
+		return orientedBox;
+	}
+	bool CollisionBox::checkMoved()
+	{
+		bool moved = boundsDirty;
+		boundsDirty = false;
+		if (gameObject != nullptr && gameObject->hasTransform())
+		{
+			unsigned version = gameObject->transform().getWorldVersion();
+			if (version != transformVersion)
 			{
-				collisionBoxes.erase(collisionBoxes.begin() + i);
+				transformVersion = version;
+				moved = true;
 			}
 		}
+		return moved;
 	}
 	bool CollisionBox::isColliding(CollisionBox& other)
 	{
-		//TODO: SAT
-		//Until then... AABB
-		glm::vec2 bottomLeft = position - origin + gameObject->transform().getPosition();
-		glm::vec2 otherBottomLeft = other.position - other.origin + other.gameObject->transform().getPosition();
-		if (bottomLeft.x + size.x < otherBottomLeft.x)
-			return false;
-		if (bottomLeft.x > otherBottomLeft.x + other.size.x)
-			return false;
-		if (bottomLeft.y + size.y < otherBottomLeft.y)
-			return false;
-		if (bottomLeft.y > otherBottomLeft.y + other.size.y)
-			return false;
-
-		return true;
+		glm::vec2 normal;
+		float depth;
+		return isColliding(other, normal, depth);
+	}
+	bool CollisionBox::isColliding(CollisionBox& other, glm::vec2& normal, float& depth)
+	{
+		return getOrientedBox().overlaps(other.getOrientedBox(), normal, depth);
 	}
 	bool CollisionBox::isColliding(glm::vec2& point)
 	{
-		float x1 = position.x - origin.x + gameObject->transform().getPosition().x;
-		if (point.x < x1)
-			return false;
-		if (point.x > x1 + size.x)
-			return false;
-		float y1 = position.y - origin.y + gameObject->transform().getPosition().y;
-		if (point.y < y1)
-			return false;
-		if (point.y > y1 + size.y)
-			return false;
-		return true;
-	}
-}
\ No newline at end of file
+		return getOrientedBox().contains(point);
+	}
+}
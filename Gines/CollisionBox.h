@@ -1,6 +1,10 @@
 #pragma once
+#include <vector>
+#include <climits>
 #include <glm/vec2.hpp>
 #include "Component.h"
+#include "Geometry.h"
+#include "Broadphase.h"
 
 namespace gines
 {
@@ -8,32 +12,84 @@ namespace gines
 	{
 	public:
 		CollisionBox();
+		CollisionBox(const CollisionBox& original);
 		~CollisionBox();
+		bool isThreadSafe(){ return true; }//No update
+		void onPrefabPrototype();//Leaves the broadphase and the box lists
 
-		//Colllision
+		//Colllision, rotated with the game object's transform
 		bool isColliding(CollisionBox& other);
+		//Also gives the penetration normal (pointing from this box towards other) and depth
+		bool isColliding(CollisionBox& other, glm::vec2& normal, float& depth);
 		bool isColliding(glm::vec2& point);
 
 		//Position
-		void setPosition(glm::vec2& vec) { position = vec; }
-		void setPosition(float x, float y) { position.x = x; position.y = y; }
-		void move(float x, float y) { position.x += x; position.y += y; }
-		void move(glm::vec2& vec) { position += vec; }
+		void setPosition(glm::vec2& vec) { position = vec; changed(); }
+		void setPosition(float x, float y) { position.x = x; position.y = y; changed(); }
+		void move(float x, float y) { position.x += x; position.y += y; changed(); }
+		void move(glm::vec2& vec) { position += vec; changed(); }
 
 		//Origin
-		void setOrigin(glm::vec2& vec){ origin = vec; }
-		void setOrigin(float x, float y){ origin.x = x; origin.y = y; }
+		void setOrigin(glm::vec2& vec){ origin = vec; changed(); }
+		void setOrigin(float x, float y){ origin.x = x; origin.y = y; changed(); }
 
 		//Size
-		void setWidth(float w) { size.x = w; }
-		void setHeight(float h){ size.y = h; }
-		void setSize(float w, float h){ size.x = w; size.y = h; }
-		void setSize(glm::vec2& newSize){ size = newSize; }
+		void setWidth(float w) { size.x = w; changed(); }
+		void setHeight(float h){ size.y = h; changed(); }
+		void setSize(float w, float h){ size.x = w; size.y = h; changed(); }
+		void setSize(glm::vec2& newSize){ size = newSize; changed(); }
+
+		/*The box rotates with the transform around position, with origin as the pivot, like Sprite.
+		Scale is not applied*/
+		const OrientedBox& getOrientedBox();
+		//World space bounds of the rotated box
+		AABB getBounds(){ return getOrientedBox().getBounds(); }
+		//True if the box or its transform has changed since the last call
+		bool checkMoved();
+
+		/*Layer bits of the box and the layers it collides with. Two boxes collide when each one's layers are in the other's mask.
+		Broadphases keep a copy that is refreshed by updateBroadphase(), along with the bounds*/
+		void setLayers(unsigned bits){ layers = bits; boundsDirty = true; }
+		void setMask(unsigned bits){ mask = bits; boundsDirty = true; }
+		unsigned getLayers(){ return layers; }
+		unsigned getMask(){ return mask; }
+		bool canCollide(CollisionBox& other){ return Broadphase::canCollide(layers, mask, other.layers, other.mask); }
+
+		/*Bullet boxes on a PhysicsComponent body are swept along the body's movement each substep, and the body stops
+		where they first touch a box that isn't on an awake dynamic body. Costs a broadphase query per substep, use it for small fast objects*/
+		void setBullet(bool enabled);
+		bool isBullet(){ return bullet; }
+
+		//Proxy id of the box in the active broadphase, UINT_MAX when not in one
+		unsigned getProxy(){ return proxy; }
+		void setProxy(unsigned id){ proxy = id; }
 
 	private:
+		void changed(){ boundsDirty = true; orientedDirty = true; }
+		void unregister();//From collisionBoxes
 		glm::vec2 size;
 		glm::vec2 position;
 		glm::vec2 origin;
-	};
+		unsigned layers = 1;
+		unsigned mask = GINES_ALL_LAYERS;
+
+		//Broadphase tracking
+		unsigned proxy = UINT_MAX;
+		unsigned registryIndex;//Position in collisionBoxes, UINT_MAX for prefab prototypes
+		unsigned bulletIndex = UINT_MAX;//Position in bulletBoxes, UINT_MAX when not listed
+		bool bullet = false;
+		bool boundsDirty = true;
+		unsigned transformVersion = 0;
+		unsigned contactCount = 0;//Tracked contacts involving this box, see ContactEvents.h
+		friend void updateContacts();
+		friend void setContactTracking(bool enabled);
+		friend void removeContacts(CollisionBox* box);
 
-}
\ No newline at end of file
+		//Cached world box
+		OrientedBox orientedBox;
+		bool orientedDirty = true;
+		unsigned orientedVersion = 0;
+	};
+	extern std::vector<CollisionBox*> collisionBoxes;//All collision boxes
+	extern std::vector<CollisionBox*> bulletBoxes;//Collision boxes with the bullet flag
+}
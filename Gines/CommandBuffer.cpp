@@ -0,0 +1,93 @@
+#include "CommandBuffer.h"
+
+namespace gines
+{
+	CommandBuffer frameCommands;
+
+	CommandBuffer::CommandBuffer()
+	{
+	}
+	CommandBuffer::~CommandBuffer()
+	{
+	}
+	void CommandBuffer::record(const Command& command)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		commands.push_back(command);
+	}
+	void CommandBuffer::spawn(std::string name, GameObjectHandle parent, std::function<void(GameObject&)> setup)
+	{
+		Command command(Command::SPAWN, GameObjectHandle(), setup);
+		command.name = name;
+		command.other = parent;
+		record(command);
+	}
+	void CommandBuffer::destroy(GameObjectHandle object)
+	{
+		record(Command(Command::DESTROY, object));
+	}
+	void CommandBuffer::reparent(GameObjectHandle object, GameObjectHandle newParent)
+	{
+		Command command(Command::REPARENT, object);
+		command.other = newParent;
+		record(command);
+	}
+	void CommandBuffer::call(GameObjectHandle object, std::function<void(GameObject&)> function)
+	{
+		record(Command(Command::CALL, object, function));
+	}
+	unsigned CommandBuffer::getCommandCount()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return commands.size();
+	}
+
+	void CommandBuffer::apply()
+	{
+		{//Take the recorded commands, new ones can be recorded while these are applied
+			std::lock_guard<std::mutex> lock(mutex);
+			if (commands.empty())
+				return;
+			applying.swap(commands);
+		}
+
+		for (unsigned i = 0; i < applying.size(); i++)
+		{
+			Command& command = applying[i];
+			if (command.type == Command::SPAWN)
+			{
+				GameObject* object = command.name.empty() ? new GameObject() : new GameObject(command.name);
+				GameObject* parent = GameObject::getGameObject(command.other);
+				if (parent != nullptr)
+					parent->addChild(object);
+				if (command.function)
+					command.function(*object);
+				continue;
+			}
+
+			//Handles of objects destroyed earlier in this batch (or their children) are stale now
+			GameObject* target = GameObject::getGameObject(command.target);
+			if (target == nullptr)
+				continue;
+			switch (command.type)
+			{
+			case Command::DESTROY:
+				delete target;
+				break;
+			case Command::REPARENT:
+			{
+				GameObject* parent = GameObject::getGameObject(command.other);
+				if (parent != nullptr || command.other == GameObjectHandle())
+					target->setParent(parent);//Skipped if the new parent has been destroyed
+				break;
+			}
+			case Command::CALL:
+				command.function(*target);
+				break;
+			default:
+				break;
+			}
+		}
+		applying.clear();
+	}
+}
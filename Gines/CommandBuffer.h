@@ -0,0 +1,79 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <mutex>
+#include <functional>
+#include "GameObject.h"
+
+/*
+Deferred structural changes. Creating, destroying or reparenting objects and adding or removing components
+while GameObject::update is iterating would invalidate the iteration, so record them instead:
+
+	gines::frameCommands.destroy(bullet->getHandle());
+	gines::frameCommands.spawn("explosion", gines::GameObjectHandle(), [](gines::GameObject& object)
+	{
+		object.addComponent<gines::Transform>();
+	});
+
+All commands recorded during a frame are applied in recording order at the start of endMainLoop().
+Commands that target an object destroyed earlier in the same batch are skipped.
+Recording is thread safe.
+*/
+namespace gines
+{
+	class CommandBuffer
+	{
+	public:
+		CommandBuffer();
+		~CommandBuffer();
+
+		//Creates a game object, attaches it to parent if the handle is valid and then calls setup
+		void spawn(std::string name, GameObjectHandle parent, std::function<void(GameObject&)> setup = nullptr);
+		void destroy(GameObjectHandle object);
+		//Passing a null handle as newParent unparents the object
+		void reparent(GameObjectHandle object, GameObjectHandle newParent);
+		template <typename T>
+		void addComponent(GameObjectHandle object)
+		{
+			record(Command(Command::CALL, object, [](GameObject& target){ target.addComponent<T>(); }));
+		}
+		template <typename T>
+		void removeComponent(GameObjectHandle object)
+		{
+			record(Command(Command::CALL, object, [](GameObject& target){ target.removeComponent<T>(); }));
+		}
+		//Calls function with the object at the sync point
+		void call(GameObjectHandle object, std::function<void(GameObject&)> function);
+
+		//Applies all recorded commands. Commands recorded while applying are left for the next apply
+		void apply();
+		unsigned getCommandCount();
+
+	private:
+		struct Command
+		{
+			enum Type
+			{
+				SPAWN,
+				DESTROY,
+				REPARENT,
+				CALL
+			};
+			Command(Type _type, GameObjectHandle _target, std::function<void(GameObject&)> _function = nullptr) :
+				type(_type), target(_target), function(_function){}
+			Type type;
+			GameObjectHandle target;
+			GameObjectHandle other;//Parent for SPAWN and REPARENT
+			std::string name;
+			std::function<void(GameObject&)> function;
+		};
+		void record(const Command& command);
+
+		std::mutex mutex;
+		std::vector<Command> commands;
+		std::vector<Command> applying;
+	};
+
+	extern CommandBuffer frameCommands;//Applied by endMainLoop()
+}
@@ -0,0 +1,12 @@
+#include "Component.h"
+
+namespace gines
+{
+	unsigned Component::componentCount = 0;
+
+	static std::atomic<unsigned> componentTypeCount;//Zero initialized
+	unsigned nextComponentTypeId()
+	{
+		return componentTypeCount++;
+	}
+}
@@ -1,22 +1,101 @@
 #pragma once
 #include <glm/vec2.hpp>
 #include <iostream>
+#include <climits>
+#include <type_traits>
+#include <atomic>
+#include <new>
 #define _USE_MATH_DEFINES
 #include <math.h>
 
 namespace gines
 {
 	class GameObject;
+	class PoolAllocator;
+	struct CollisionEvent;
 	class Component
 	{
 	public:
-		Component(){}
-		virtual ~Component(){};
+		Component(){ componentCount++; }
+		Component(const Component&){ componentCount++; }//Copies are not attached to anything, see Prefab
+		virtual ~Component(){ componentCount--; };
+		Component& operator=(const Component&){ return *this; }//Keeps the attachment of the target
 		virtual void update(){}
 		virtual void render(){}
+		/*Return true if update() only touches this component's own game object and does not add or remove objects or components.
+		Thread safe components may be updated from worker threads, see GameObject::setUpdateMode. Must not change over the component's lifetime.*/
+		virtual bool isThreadSafe(){ return false; }
+		/*Called on the copy that a Prefab keeps of this component. Components that register themselves somewhere
+		in their constructor should unregister here so that the copy stays inert*/
+		virtual void onPrefabPrototype(){}
+		//Contact events of the collision boxes on this component's game object, see ContactEvents.h
+		virtual void onCollision(const CollisionEvent&){}
 		void setGameObject(gines::GameObject* object){ gameObject = object; }
+		gines::GameObject* getGameObject(){ return gameObject; }
+		unsigned getTypeId(){ return typeId; }//See ComponentType<T>::id()
+		static unsigned getComponentCount(){ return componentCount; }//Number of live component instances
 	protected:
-		gines::GameObject* gameObject;//A pointer to the game object that this component is attached to
+		gines::GameObject* gameObject = nullptr;//A pointer to the game object that this component is attached to
+	private:
+		friend class GameObject;
+		friend class World;
+		friend class Prefab;
+		unsigned typeId = 0;//Set by GameObject::addComponent
+		bool threadSafe = false;//Cached isThreadSafe() result, set by GameObject::addComponent
+		unsigned updateListIndex = UINT_MAX;//Position in the type's update list, UINT_MAX if the type doesn't override update()
+		unsigned renderListIndex = UINT_MAX;
+		bool worldStorage = false;//Memory is owned by a World archetype instead of the heap
+		PoolAllocator* pool = nullptr;//Pool that the component was allocated from, nullptr if allocated with new
+		static unsigned componentCount;
+	};
+
+	//Returns a new component type id
+	unsigned nextComponentTypeId();
+
+	/*Component type ids are small integers that are given to each component type the first time it is used,
+	from any thread. Game objects use them to index their component slot tables.*/
+	template <typename T>
+	struct ComponentType
+	{
+		static unsigned id()
+		{//The first call can come from several update jobs at once, only one of the ids they draw is kept
+			unsigned stored = slot.load();
+			if (stored == 0)
+			{
+				unsigned expected = 0;
+				const unsigned drawn = nextComponentTypeId() + 1;
+				stored = slot.compare_exchange_strong(expected, drawn) ? drawn : expected;
+			}
+			return stored - 1;
+		}
+	private:
+		static std::atomic<unsigned> slot;//Id + 1, 0 until assigned. Zero initialized, so no static initialization order issues
+	};
+	template <typename T>
+	std::atomic<unsigned> ComponentType<T>::slot;
+
+	/*Tells whether T overrides update() or render(). Components that don't are left out of the update and render lists.
+	&T::update names Component::update unless T or one of its bases between T and Component declares update()*/
+	template <typename T>
+	struct ComponentOverrides
+	{
+		static const bool update = !std::is_same<decltype(&T::update), void (Component::*)()>::value;
+		static const bool render = !std::is_same<decltype(&T::render), void (Component::*)()>::value;
+	};
+
+	/*Copies a component of type T into memory with its copy constructor.
+	get() returns nullptr for types that can't be copied, those are left out of prefabs*/
+	typedef Component* (*ComponentCloneFunction)(const Component& source, void* memory);
+	template <typename T, bool Copyable = std::is_copy_constructible<T>::value>
+	struct ComponentCloner
+	{
+		static Component* clone(const Component& source, void* memory){ return new (memory) T(static_cast<const T&>(source)); }
+		static ComponentCloneFunction get(){ return &clone; }
+	};
+	template <typename T>
+	struct ComponentCloner<T, false>
+	{
+		static ComponentCloneFunction get(){ return nullptr; }
 	};
 
 	class MonoComponent : public Component
@@ -33,10 +112,12 @@ namespace gines
 ///////////////////////////////
 
 1. Create a new class, inherit from Component ( : public Component )
-2. Implement void update() and render() functions (if needed). These are automatically called for you from GameObject
-3. call gameobject.addComponent<NewComponentYouJustCreated>();
-4. ???
-5. profit
+2. Implement void update() and render() functions (if needed). These are automatically called for you from GameObject.
+   Don't declare them if they would be empty, components without them are skipped entirely
+3. Override bool isThreadSafe() to return true if update() only touches its own game object
+4. call gameobject.addComponent<NewComponentYouJustCreated>();
+5. ???
+6. profit
 
 */
 
@@ -63,6 +63,10 @@ namespace gines
 	}
 	void Console::log(std::string str)
 	{
+		if (echo)
+		{
+			std::cout << str << std::endl;
+		}
 		if (lines.size() >= consoleLines)
 		{
 			delete lines[0];//Delete data
@@ -244,19 +248,25 @@ namespace gines
 		consoleText->render();
 	}
 	void Console::executeConsole()
+	{
+		execute(input);
+		input = "";
+		consoleText->setString("><");
+	}
+	void Console::execute(std::string line)
 	{
 		//Record each word as a different element in console words vector
 		bool foundCommand = false;
 		consoleWords.clear();
 		consoleWords.push_back(std::string(""));
-		for (unsigned i = 0; i < input.size(); i++)
+		for (unsigned i = 0; i < line.size(); i++)
 		{
-			if (input[i] != '\0')
+			if (line[i] != '\0' && line[i] != '\r' && line[i] != '\n')
 			{
-				if (input[i] == ' ')
+				if (line[i] == ' ')
 					consoleWords.push_back(std::string(""));
 				else//Record character
-					consoleWords.back() += input[i];
+					consoleWords.back() += line[i];
 			}
 			else
 			{
@@ -290,8 +300,6 @@ namespace gines
 			}
 		}
 
-		input = "";
-		consoleText->setString("><");
 		if (!foundCommand)
 		{
 			log("Unknown command");
@@ -302,7 +310,17 @@ namespace gines
 		bool foundVariable = false;
 		bool isFloat = false;
 		for (unsigned i = 0; i < consoleWords[2].size(); i++)
-			if ((consoleWords[2][i] < 48 || consoleWords[2][i] > 57) && consoleWords[2][i] != 45)//if the character is not "numeric" (number or -)
+			if (consoleWords[2][i] == 46)//Test for period (decimal numbers/aka floats)
+			{
+				if (isFloat == false)
+					isFloat = true;
+				else
+				{
+					log("Invalid command!");
+					return;
+				}
+			}
+			else if ((consoleWords[2][i] < 48 || consoleWords[2][i] > 57) && consoleWords[2][i] != 45)//if the character is not "numeric" (number or -)
 			{//Value is not numeric
 				if (consoleWords[2] == "true" || consoleWords[2] == "false")
 				{
@@ -327,38 +345,28 @@ namespace gines
 					return;
 				}
 			}
-			else if (consoleWords[2][i] == 46)//Test for period (decimal numbers/aka floats)
-			{
-				if (isFloat == false)
-					isFloat = true;
-				else
-				{
-					log("Invalid command!");
-					return;
-				}
-			}
 
-		if (isFloat)
+		if (!isFloat)
 		{
-			for (unsigned i = 0; i < floatVariables.size(); i++)
-				if (floatVariables[i].identifier == consoleWords[1])
+			for (unsigned i = 0; i < intVariables.size(); i++)
+				if (intVariables[i].identifier == consoleWords[1])
 				{
 					{
 						foundVariable = true;
-						floatVariables[i].set(atoi(consoleWords[2].c_str()));
-						log("Setting " + floatVariables[i].identifier + " to " + consoleWords[2]);
+						intVariables[i].set(atoi(consoleWords[2].c_str()));
+						log("Setting " + intVariables[i].identifier + " to " + consoleWords[2]);
 					}
 				}
 		}
-		else
-		{
-			for (unsigned i = 0; i < intVariables.size(); i++)
-				if (intVariables[i].identifier == consoleWords[1])
+		if (!foundVariable)
+		{//Float variables also accept integer values
+			for (unsigned i = 0; i < floatVariables.size(); i++)
+				if (floatVariables[i].identifier == consoleWords[1])
 				{
 					{
 						foundVariable = true;
-						intVariables[i].set(atoi(consoleWords[2].c_str()));
-						log("Setting " + intVariables[i].identifier + " to " + consoleWords[2]);
+						floatVariables[i].set(float(atof(consoleWords[2].c_str())));
+						log("Setting " + floatVariables[i].identifier + " to " + consoleWords[2]);
 					}
 				}
 		}
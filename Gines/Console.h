@@ -52,12 +52,15 @@ namespace gines
 		void addVariable(std::string str, int& var);
 		void addConsoleCommand(std::string str, void(*fnc)(std::vector<std::string>&));
 		void log(std::string str);
+		void execute(std::string line);//Executes a command line as if it was typed into the console
+		void setEcho(bool setting){ echo = setting; }//Mirrors log lines to stdout
 		void openConsole();
 		void closeConsole();
 		
 	private:
 		int visibility = 255;
 		bool open = false;
+		bool echo = false;
 		std::string input;
 		Text* consoleText;
 		std::vector<Text*> lines;
@@ -0,0 +1,225 @@
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <iostream>
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <sys/un.h>
+#endif
+
+#include "ConsoleInput.h"
+#include "Gines.h"
+
+#define CONSOLE_INPUT_QUEUE_SIZE 256	//Must be a power of two
+#define CONSOLE_INPUT_POLL_MS 100		//How often the reader thread checks whether it should stop
+
+namespace gines
+{
+	/*Single producer (reader thread), single consumer (main thread) ring buffer*/
+	class LineQueue
+	{
+	public:
+		LineQueue() : head(0), tail(0){}
+		bool push(std::string& line)
+		{
+			unsigned t = tail.load(std::memory_order_relaxed);
+			if (t - head.load(std::memory_order_acquire) == CONSOLE_INPUT_QUEUE_SIZE)
+				return false;//Full
+			slots[t & (CONSOLE_INPUT_QUEUE_SIZE - 1)].swap(line);
+			tail.store(t + 1, std::memory_order_release);
+			return true;
+		}
+		bool pop(std::string& line)
+		{
+			unsigned h = head.load(std::memory_order_relaxed);
+			if (h == tail.load(std::memory_order_acquire))
+				return false;//Empty
+			line.swap(slots[h & (CONSOLE_INPUT_QUEUE_SIZE - 1)]);
+			slots[h & (CONSOLE_INPUT_QUEUE_SIZE - 1)].clear();
+			head.store(h + 1, std::memory_order_release);
+			return true;
+		}
+	private:
+		std::string slots[CONSOLE_INPUT_QUEUE_SIZE];
+		std::atomic<unsigned> head;
+		std::atomic<unsigned> tail;
+	};
+
+	//Local variables
+	static LineQueue lineQueue;
+	static std::thread readerThread;
+	static std::atomic<bool> running(false);
+	static ConsoleInputSource activeSource = ConsoleInputSource::NONE;
+	static std::string activeSocketPath;
+
+	static void queueLine(std::string& line)
+	{
+		if (line.empty())
+			return;
+		//Main thread drains the queue once per frame, wait for room instead of dropping commands
+		while (!lineQueue.push(line) && running.load())
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+
+#ifndef _WIN32
+	/*Waits until fd is readable or the poll interval has passed. Returns false on error*/
+	static bool waitReadable(int fd, bool& readable)
+	{
+		fd_set set;
+		FD_ZERO(&set);
+		FD_SET(fd, &set);
+		timeval timeout;
+		timeout.tv_sec = 0;
+		timeout.tv_usec = CONSOLE_INPUT_POLL_MS * 1000;
+		int result = select(fd + 1, &set, nullptr, nullptr, &timeout);
+		readable = result > 0;
+		return result >= 0;
+	}
+
+	/*Reads fd until it closes, splitting the stream into lines*/
+	static void readLines(int fd)
+	{
+		std::string line;
+		char buffer[512];
+		bool readable;
+		while (running.load() && waitReadable(fd, readable))
+		{
+			if (!readable)
+				continue;
+			ssize_t count = read(fd, buffer, sizeof(buffer));
+			if (count <= 0)
+				break;//Closed
+			for (ssize_t i = 0; i < count; i++)
+			{
+				if (buffer[i] == '\n')
+					queueLine(line);
+				else
+					line += buffer[i];
+			}
+		}
+		queueLine(line);
+	}
+
+	static void socketReader(int listenSocket)
+	{
+		bool readable;
+		while (running.load() && waitReadable(listenSocket, readable))
+		{
+			if (!readable)
+				continue;
+			int client = accept(listenSocket, nullptr, nullptr);
+			if (client < 0)
+				continue;
+			readLines(client);
+			close(client);
+		}
+		close(listenSocket);
+		unlink(activeSocketPath.c_str());
+	}
+
+	static void stdinReader()
+	{
+		readLines(STDIN_FILENO);
+	}
+#else
+	static void stdinReader()
+	{
+		//std::getline cannot be interrupted, the thread is detached on stop
+		std::string line;
+		while (running.load() && std::getline(std::cin, line))
+		{
+			queueLine(line);
+		}
+	}
+#endif
+
+	bool startConsoleInput(ConsoleInputSource source, std::string socketPath)
+	{
+		if (activeSource != ConsoleInputSource::NONE)
+		{
+			Message("Console input already started!", gines::Message::Warning);
+			return false;
+		}
+
+		if (source == ConsoleInputSource::STDIN)
+		{
+			running.store(true);
+			readerThread = std::thread(stdinReader);
+		}
+		else if (source == ConsoleInputSource::SOCKET)
+		{
+#ifndef _WIN32
+			sockaddr_un address = {};
+			if (socketPath.size() >= sizeof(address.sun_path))
+			{
+				Message("Console input socket path is too long!", gines::Message::Warning);
+				return false;
+			}
+			int listenSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+			if (listenSocket < 0)
+			{
+				Message("Failed to create console input socket!", gines::Message::Warning);
+				return false;
+			}
+			address.sun_family = AF_UNIX;
+			socketPath.copy(address.sun_path, socketPath.size());
+			unlink(socketPath.c_str());//Remove a stale socket left by a crashed instance
+			if (bind(listenSocket, (sockaddr*)&address, sizeof(address)) != 0 || listen(listenSocket, 1) != 0)
+			{
+				Message("Failed to bind console input socket!", gines::Message::Warning);
+				close(listenSocket);
+				return false;
+			}
+			activeSocketPath = socketPath;
+			running.store(true);
+			readerThread = std::thread(socketReader, listenSocket);
+#else
+			Message("Console input sockets are not supported on this platform!", gines::Message::Warning);
+			return false;
+#endif
+		}
+		else
+		{
+			return false;
+		}
+
+		activeSource = source;
+		console.setEcho(true);
+		Message("Console input started", gines::Message::Info);
+		return true;
+	}
+
+	void stopConsoleInput()
+	{
+		if (activeSource == ConsoleInputSource::NONE)
+		{
+			return;
+		}
+		running.store(false);
+#ifndef _WIN32
+		readerThread.join();
+#else
+		readerThread.detach();
+#endif
+		activeSource = ConsoleInputSource::NONE;
+		console.setEcho(false);
+	}
+
+	void pollConsoleInput()
+	{
+		if (activeSource == ConsoleInputSource::NONE)
+		{
+			return;
+		}
+		std::string line;
+		while (lineQueue.pop(line))
+		{
+			console.execute(line);
+		}
+	}
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <string>
+
+/*
+Scriptable console input. Lines are read on a background thread from stdin or a local
+(Unix domain) socket, queued without locks and executed at the start of the next frame
+through the regular console command registry. For example:
+	echo "set maxFPS 30" | socat - UNIX-CONNECT:gines.sock
+*/
+namespace gines
+{
+	enum class ConsoleInputSource
+	{
+		NONE,
+		STDIN,
+		SOCKET
+	};
+
+	//Starts reading console lines from the given source. Only one source can be active at a time
+	bool startConsoleInput(ConsoleInputSource source, std::string socketPath = "gines.sock");
+	void stopConsoleInput();
+	//Executes all queued lines, called from beginMainLoop()
+	void pollConsoleInput();
+}
@@ -0,0 +1,163 @@
+#include "ContactEvents.h"
+#include "CollisionBox.h"
+#include "GameObject.h"
+#include <algorithm>
+#include <functional>
+
+namespace gines
+{
+	static bool tracking = false;
+	static std::vector<Contact> contacts;//Sorted by box pair, a before b
+	static std::vector<Contact> found;//Contacts of the frame being updated
+	static std::vector<CollisionPair> pairs;
+	static std::vector<CollisionEvent> events;//Batch being dispatched
+	static bool dispatching = false;
+
+	static bool pairLess(const Contact& left, const Contact& right)
+	{
+		std::less<CollisionBox*> less;
+		if (left.a != right.a)
+			return less(left.a, right.a);
+		return less(left.b, right.b);
+	}
+	//One event for each box, seen from that box
+	static void addEvents(CollisionEventType type, const Contact& contact)
+	{
+		CollisionEvent event;
+		event.type = type;
+		event.self = contact.a;
+		event.other = contact.b;
+		event.normal = contact.normal;
+		event.depth = contact.depth;
+		events.push_back(event);
+		event.self = contact.b;
+		event.other = contact.a;
+		event.normal = -contact.normal;
+		events.push_back(event);
+	}
+	static void dispatchEvents()
+	{
+		//Handlers may destroy boxes, removeContacts() clears them from the batch and appends their exits
+		dispatching = true;
+		for (unsigned i = 0; i < events.size(); i++)
+		{
+			const CollisionEvent event = events[i];
+			if (event.self != nullptr && event.self->getGameObject() != nullptr)
+				event.self->getGameObject()->sendCollisionEvent(event);
+		}
+		events.clear();
+		dispatching = false;
+	}
+
+	void setContactTracking(bool enabled)
+	{
+		tracking = enabled;
+		if (!enabled)
+		{
+			for (unsigned i = 0; i < contacts.size(); i++)
+			{
+				contacts[i].a->contactCount = 0;
+				contacts[i].b->contactCount = 0;
+			}
+			contacts.clear();
+		}
+	}
+	bool getContactTracking()
+	{
+		return tracking;
+	}
+	const std::vector<Contact>& getContacts()
+	{
+		return contacts;
+	}
+
+	void updateContacts()
+	{
+		if (!tracking)
+			return;
+		pairs.clear();
+		found.clear();
+		getBroadphase()->queryPairs(pairs);
+		findContacts(pairs, found);
+
+		//Same box order as the persistent set
+		std::less<CollisionBox*> less;
+		for (unsigned i = 0; i < found.size(); i++)
+		{
+			if (less(found[i].b, found[i].a))
+			{
+				std::swap(found[i].a, found[i].b);
+				found[i].normal = -found[i].normal;
+			}
+		}
+		std::sort(found.begin(), found.end(), pairLess);
+
+		//Walk both sorted sets side by side
+		unsigned previous = 0;
+		unsigned current = 0;
+		while (previous < contacts.size() || current < found.size())
+		{
+			if (current == found.size() || (previous < contacts.size() && pairLess(contacts[previous], found[current])))
+			{
+				Contact ended = contacts[previous++];
+				ended.normal = glm::vec2(0.0f, 0.0f);
+				ended.depth = 0.0f;
+				ended.a->contactCount--;
+				ended.b->contactCount--;
+				addEvents(CollisionEventType::Exit, ended);
+			}
+			else if (previous == contacts.size() || pairLess(found[current], contacts[previous]))
+			{
+				const Contact& started = found[current++];
+				started.a->contactCount++;
+				started.b->contactCount++;
+				addEvents(CollisionEventType::Enter, started);
+			}
+			else
+			{
+				addEvents(CollisionEventType::Stay, found[current]);
+				previous++;
+				current++;
+			}
+		}
+		contacts.swap(found);
+		dispatchEvents();
+	}
+
+	void removeContacts(CollisionBox* box)
+	{
+		for (unsigned i = 0; i < events.size(); i++)
+		{
+			if (events[i].self == box)
+				events[i].self = nullptr;
+			if (events[i].other == box)
+				events[i].other = nullptr;
+		}
+		if (box->contactCount == 0)
+			return;
+
+		unsigned write = 0;
+		for (unsigned read = 0; read < contacts.size(); read++)
+		{
+			Contact& contact = contacts[read];
+			if (contact.a == box || contact.b == box)
+			{
+				CollisionBox* survivor = contact.a == box ? contact.b : contact.a;
+				survivor->contactCount--;
+				CollisionEvent event;
+				event.type = CollisionEventType::Exit;
+				event.self = survivor;
+				event.other = nullptr;
+				event.normal = glm::vec2(0.0f, 0.0f);
+				event.depth = 0.0f;
+				events.push_back(event);
+				continue;
+			}
+			contacts[write++] = contact;
+		}
+		contacts.resize(write);
+		box->contactCount = 0;
+		if (!dispatching)
+			dispatchEvents();
+	}
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vector>
+#include <glm/vec2.hpp>
+#include "Narrowphase.h"
+
+/*
+Persistent contacts between collision boxes. While tracking is on, updateContacts() finds the contacts of the frame,
+diffs them against the previous frame and sends the resulting enter, stay and exit events to the components
+on both game objects in one batch:
+
+	gines::setContactTracking(true);
+	class Spikes : public gines::Component
+	{
+		void onCollision(const gines::CollisionEvent& event)
+		{
+			if (event.type == gines::CollisionEventType::Enter) ...
+		}
+	};
+
+updateContacts() is called from beginMainLoop() right after updateBroadphase().
+When a box is destroyed its contacts end right away, the other box gets an exit event with other set to nullptr.
+*/
+namespace gines
+{
+	class CollisionBox;
+	enum class CollisionEventType
+	{
+		Enter,	//Boxes started touching this frame
+		Stay,	//Boxes were already touching on the previous frame
+		Exit	//Boxes stopped touching
+	};
+	struct CollisionEvent
+	{
+		CollisionEventType type;
+		CollisionBox* self;//Box on the game object receiving the event
+		CollisionBox* other;//nullptr if the other box has been destroyed
+		glm::vec2 normal;//Points from self towards other, zero on exit
+		float depth;
+	};
+
+	//Contacts are only tracked while enabled. Disabling drops the current contacts without exit events
+	void setContactTracking(bool enabled);
+	bool getContactTracking();
+	void updateContacts();
+	//Contacts of the last update, each pair once
+	const std::vector<Contact>& getContacts();
+	//Ends the contacts of a box that is going away, called by the CollisionBox destructor
+	void removeContacts(CollisionBox* box);
+}
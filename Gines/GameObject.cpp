@@ -1,4 +1,7 @@
 #include "GameObject.h"
+#include "World.h"
+#include "JobSystem.h"
+#include <climits>
 #include "Error.hpp""
 
 /*Game object global states
@@ -11,8 +14,40 @@
 static GINES_GO_STATE_DATA_TYPE GAME_OBJECT_STATE = GINES_GO_USE_INDEX_NAMING | GINES_GO_NOTIFY_PARENT;//Sets these bits to 1's
 namespace gines
 {
-	static std::vector<gines::GameObject*> gameObjects;//All the game objects. TODO: better performance (getGameObject(stringName) goes through the entire vector)
 	Transform nulltransform;
+	static UpdateMode updateMode = UpdateMode::Serial;
+	//Components of each type that override update() or render(), indexed by type id
+	static std::vector<std::vector<Component*>> typeUpdateLists;
+	static std::vector<std::vector<Component*>> typeRenderLists;
+
+	/*Game object registry (slot map)
+		-gameObjects is a dense array of all game objects, removal swaps the last object into the hole
+		-Handles index registrySlots, which point to the dense array and hold the generation of the current occupant
+		-Generation is bumped when the object is destroyed, which invalidates all of its handles
+	*/
+	struct RegistrySlot
+	{
+		unsigned denseIndex;//Position in gameObjects, or the next free slot when unused
+		unsigned generation;
+	};
+	static std::vector<gines::GameObject*> gameObjects;//All the game objects
+	static std::vector<RegistrySlot> registrySlots;
+	static unsigned freeRegistrySlot = UINT_MAX;
+
+	/*Name intern table
+		-Each distinct name gets an id, objects sharing a name share the id
+		-Entry lists the objects that currently use the name, so name lookups don't scan gameObjects
+		-Ids are never reused, an id held by the caller keeps meaning the same name after its objects are gone
+	*/
+	struct NameEntry
+	{
+		std::string name;
+		std::vector<GameObject*> objects;
+	};
+	static std::unordered_map<std::string, unsigned> nameIds;
+	static std::vector<NameEntry> nameEntries;
+	static unsigned gameObjectIndex = 0;//Used for index naming
+
 	namespace state
 	{
 		void enable(GINES_GO_STATE_DATA_TYPE bit)
@@ -34,40 +69,135 @@ namespace gines
 			return false;
 		}
 	}
+	unsigned GameObject::getGameObjectCount() {
+		return gameObjects.size();
+	}
+	GameObject* GameObject::getGameObject(GameObjectHandle handle) {
+		if (handle.index >= registrySlots.size() || registrySlots[handle.index].generation != handle.generation) {
+			return nullptr;
+		}
+		return gameObjects[registrySlots[handle.index].denseIndex];
+	}
+	GameObjectHandle GameObject::getHandle() {
+		return GameObjectHandle(registrySlot, registrySlots[registrySlot].generation);
+	}
+	void GameObject::registerObject() {
+		if (freeRegistrySlot == UINT_MAX)
+		{
+			registrySlot = registrySlots.size();
+			RegistrySlot slot = { 0, 1 };
+			registrySlots.push_back(slot);
+		}
+		else
+		{
+			registrySlot = freeRegistrySlot;
+			freeRegistrySlot = registrySlots[registrySlot].denseIndex;
+		}
+		registrySlots[registrySlot].denseIndex = gameObjects.size();
+		gameObjects.push_back(this);
+	}
+	void GameObject::unregisterObject() {
+		//Swap and pop
+		unsigned denseIndex = registrySlots[registrySlot].denseIndex;
+		gameObjects[denseIndex] = gameObjects.back();
+		registrySlots[gameObjects[denseIndex]->registrySlot].denseIndex = denseIndex;
+		gameObjects.pop_back();
+
+		//Invalidate handles and free the slot
+		RegistrySlot& slot = registrySlots[registrySlot];
+		if (++slot.generation == 0)
+			slot.generation = 1;
+		slot.denseIndex = freeRegistrySlot;
+		freeRegistrySlot = registrySlot;
+	}
 	GameObject* GameObject::getGameObject(std::string gameObjectName) {
-		for (unsigned i = 0; i < gameObjects.size(); i++) {
-			if (gameObjects[i]->getNameReference() == gameObjectName) {
-				return gameObjects[i];
-			}
+		auto it = nameIds.find(gameObjectName);
+		if (it == nameIds.end() || nameEntries[it->second].objects.empty()) {
+			return nullptr;
 		}
-		return nullptr;
+		return nameEntries[it->second].objects.front();
+	}
+	GameObject* GameObject::getGameObject(unsigned id) {
+		if (id >= nameEntries.size() || nameEntries[id].objects.empty()) {
+			return nullptr;
+		}
+		return nameEntries[id].objects.front();
+	}
+	void GameObject::indexName() {
+		auto it = nameIds.find(name);
+		if (it == nameIds.end())
+		{//First object with this name, intern it
+			nameId = nameEntries.size();
+			nameEntries.push_back(NameEntry());
+			nameEntries[nameId].name = name;
+			nameIds[name] = nameId;
+		}
+		else
+		{
+			nameId = it->second;
+		}
+		nameSlot = nameEntries[nameId].objects.size();
+		nameEntries[nameId].objects.push_back(this);
+	}
+	void GameObject::unindexName() {
+		std::vector<GameObject*>& objects = nameEntries[nameId].objects;
+		//Swap and pop
+		objects[nameSlot] = objects.back();
+		objects[nameSlot]->nameSlot = nameSlot;
+		objects.pop_back();
+		if (objects.empty())
+		{//Keep the name and its id, only the list memory is released
+			std::vector<GameObject*>().swap(objects);
+		}
+	}
+	void GameObject::rename(std::string newName) {
+		unindexName();
+		name = newName;
+		indexName();
 	}
 
 
 	GameObject::GameObject()
 	{//Default constructor
 
-
-		//Called for every game object
-		static unsigned gameObjectIndex = 0;
-		gameObjectIndex++;
-
 		//Name each game object with index so that each object has a different name by default
 		if (state::isEnabled(GINES_GO_USE_INDEX_NAMING))//Check whether to avoid index naming this time
 		{//Use index naming
-			name = "GameObject" + gameObjectIndex;
+			name = "GameObject" + std::to_string(++gameObjectIndex);
 		}
 		else
 		{//Do not name the object here
 			state::enable(GINES_GO_USE_INDEX_NAMING);//Sets the state to use index naming next time
 		}
-		gameObjects.push_back(this);
+		registerObject();
+		indexName();
 	}
-	GameObject::GameObject(std::string gameObjectName)
+	GameObject::GameObject(std::string gameObjectName) : name(gameObjectName)
 	{//Naming constructor
-		state::disable(GINES_GO_USE_INDEX_NAMING);//Clear this bit so that index naming is not used
-		GameObject();
-		name = gameObjectName;
+		registerObject();
+		indexName();
+	}
+	GameObject::GameObject(InternedName internedName) : name(nameEntries[internedName.id].name)
+	{//Prefab constructor, name entries are never removed
+		registerObject();
+		nameId = internedName.id;
+		nameSlot = nameEntries[nameId].objects.size();
+		nameEntries[nameId].objects.push_back(this);
+	}
+	void GameObject::reserve(unsigned count) {
+		gameObjects.reserve(gameObjects.size() + count);
+		registrySlots.reserve(registrySlots.size() + count);
+	}
+	void GameObject::reserveName(unsigned id, unsigned count) {
+		std::vector<GameObject*>& objects = nameEntries[id].objects;
+		objects.reserve(objects.size() + count);
+	}
+	GameObject::ComponentTypeInfo& GameObject::getComponentTypeInfo(unsigned typeId) {
+		static std::vector<ComponentTypeInfo> componentTypeInfos;//Indexed by type id
+		if (typeId >= componentTypeInfos.size()) {
+			componentTypeInfos.resize(typeId + 1);
+		}
+		return componentTypeInfos[typeId];
 	}
 	GameObject::~GameObject() {
 
@@ -85,7 +215,7 @@ namespace gines
 
 		//Free component memory
 		while (!components.empty()) {
-			delete components.back();
+			destroyComponent(components.back());
 			components.pop_back();
 		}
 
@@ -96,30 +226,308 @@ namespace gines
 			children.pop_back();
 		}
 
-		//Remove self from game objects vector
-		for (unsigned i = 0; i < gameObjects.size(); i++) {
-			if (gameObjects[i] == this) {
-				gameObjects.erase(gameObjects.begin() + i);
+		unindexName();
+		if (archetype != nullptr) {
+			archetype->releaseRow(archetypeRow);
+		}
+
+		unregisterObject();
+	}
+	void GameObject::update() {
+		//Structural changes during update should go through frameCommands (CommandBuffer.h)
+		switch (updateMode) {
+		case UpdateMode::Parallel:
+			updateParallel();
+			break;
+		case UpdateMode::Deterministic:
+			updateDeterministic();
+			break;
+		default:
+			updateSerial();
+			break;
+		}
+	}
+	void GameObject::setUpdateMode(UpdateMode mode) {
+		updateMode = mode;
+	}
+	UpdateMode GameObject::getUpdateMode() {
+		return updateMode;
+	}
+	void GameObject::updateSerial() {
+		for (unsigned i = 0; i < updaters.size(); i++) {
+			updaters[i]->update();
+		}
+		for (unsigned i = 0; i < children.size(); i++) {
+			children[i]->updateSerial();
+		}
+	}
+
+	//Splits count items into ranges so that every worker gets a few of them
+	static unsigned updateGrainSize(unsigned count) {
+		unsigned ranges = (getWorkerCount() + 1) * 4;
+		return count / ranges > 0 ? count / ranges : 1;
+	}
+
+	/*Parallel update
+		-Each range of children is a job that updates thread safe components and collects the rest in walk order
+		-Collected components are updated serially once all jobs are done
+	*/
+	void GameObject::updateParallel() {
+		std::vector<Component*> deferred;
+		for (unsigned i = 0; i < updaters.size(); i++) {
+			if (updaters[i]->threadSafe)
+				updaters[i]->update();
+			else
+				deferred.push_back(updaters[i]);
+		}
+
+		if (!children.empty()) {
+			const unsigned grainSize = updateGrainSize(children.size());
+			std::vector<std::vector<Component*>> rangeDeferred((children.size() + grainSize - 1) / grainSize);
+			parallelFor(0, children.size(), grainSize, [this, grainSize, &rangeDeferred](unsigned begin, unsigned end) {
+				std::vector<Component*>& rangeList = rangeDeferred[begin / grainSize];
+				for (unsigned i = begin; i < end; i++) {
+					children[i]->updateCollect(rangeList);
+				}
+			});
+			for (unsigned i = 0; i < rangeDeferred.size(); i++) {
+				deferred.insert(deferred.end(), rangeDeferred[i].begin(), rangeDeferred[i].end());
+			}
+		}
+
+		for (unsigned i = 0; i < deferred.size(); i++) {
+			deferred[i]->update();
+		}
+	}
+	void GameObject::updateCollect(std::vector<Component*>& deferred) {
+		for (unsigned i = 0; i < updaters.size(); i++) {
+			if (updaters[i]->threadSafe)
+				updaters[i]->update();
+			else
+				deferred.push_back(updaters[i]);
+		}
+		for (unsigned i = 0; i < children.size(); i++) {
+			children[i]->updateCollect(deferred);
+		}
+	}
+
+	/*Deterministic update
+		-Walks the hierarchy in serial order, thread safe subtrees and runs of thread safe components are queued as tasks
+		-A run of components is one task, so components of one object never run at the same time and see each other's writes in order
+		-Unsafe component runs the queued tasks in parallel first and is then updated on the calling thread,
+		 so it sees exactly the state it would see in the serial walk
+		-Queued components of an object are run before its children are scheduled, so no subtree runs alongside its ancestors
+	*/
+	struct GameObject::UpdateTask {
+		UpdateTask(GameObject* _object, unsigned _first, unsigned _last) : object(_object), first(_first), last(_last){}
+		GameObject* object;
+		unsigned first;//Updaters [first, last) of the object, the whole subtree when first is UINT_MAX
+		unsigned last;
+	};
+	void GameObject::updateDeterministic() {
+		markUpdateSafety();
+		std::vector<UpdateTask> pending;
+		scheduleUpdate(pending);
+		runUpdateTasks(pending);
+	}
+	bool GameObject::markUpdateSafety() {
+		subtreeUpdateSafe = true;
+		for (unsigned i = 0; i < updaters.size(); i++) {
+			if (!updaters[i]->threadSafe) {
+				subtreeUpdateSafe = false;
 				break;
 			}
 		}
+		for (unsigned i = 0; i < children.size(); i++) {
+			if (!children[i]->markUpdateSafety())
+				subtreeUpdateSafe = false;
+		}
+		return subtreeUpdateSafe;
 	}
-	void GameObject::update() {
-		for (unsigned i = 0; i < components.size(); i++) {
-			components[i]->update();
+	void GameObject::scheduleUpdate(std::vector<UpdateTask>& pending) {
+		if (subtreeUpdateSafe) {
+			pending.push_back(UpdateTask(this, UINT_MAX, UINT_MAX));
+			return;
 		}
-		for (auto it : children) {
-			it->update();
+		bool ownQueued = false;
+		unsigned u = 0;
+		while (u < updaters.size()) {
+			if (updaters[u]->threadSafe) {
+				unsigned last = u + 1;
+				while (last < updaters.size() && updaters[last]->threadSafe)
+					last++;
+				pending.push_back(UpdateTask(this, u, last));
+				ownQueued = true;
+				u = last;
+			}
+			else {
+				runUpdateTasks(pending);
+				ownQueued = false;
+				updaters[u]->update();
+				u++;
+			}
+		}
+		if (ownQueued)
+			runUpdateTasks(pending);//Children read the transforms these may write
+		for (unsigned i = 0; i < children.size(); i++) {
+			children[i]->scheduleUpdate(pending);
 		}
 	}
-	void GameObject::render() {
+	void GameObject::runUpdateTasks(std::vector<UpdateTask>& tasks) {
+		if (tasks.empty())
+			return;
+		parallelFor(0, tasks.size(), updateGrainSize(tasks.size()), [&tasks](unsigned begin, unsigned end) {
+			for (unsigned i = begin; i < end; i++) {
+				const UpdateTask& task = tasks[i];
+				if (task.first == UINT_MAX) {
+					task.object->updateSerial();
+					continue;
+				}
+				for (unsigned u = task.first; u < task.last; u++)
+					task.object->updaters[u]->update();
+			}
+		});
+		tasks.clear();
+	}
+	void GameObject::sendCollisionEvent(const CollisionEvent& event) {
 		for (unsigned i = 0; i < components.size(); i++) {
-			components[i]->render();
+			components[i]->onCollision(event);
+		}
+	}
+	void GameObject::render() {
+		for (unsigned i = 0; i < renderers.size(); i++) {
+			renderers[i]->render();
 		}
 		for (auto it : children) {
 			it->render();
 		}
 	}
+	void* GameObject::operator new(size_t size) {
+		if (size != sizeof(GameObject))
+			return ::operator new(size);
+		return getPool<GameObject>().allocate();
+	}
+	void GameObject::operator delete(void* pointer, size_t size) {
+		if (size != sizeof(GameObject))
+			::operator delete(pointer);
+		else
+			getPool<GameObject>().free(pointer);
+	}
+	void GameObject::updateAllByType() {
+		for (unsigned type = 0; type < typeUpdateLists.size(); type++) {
+			std::vector<Component*>& list = typeUpdateLists[type];
+			for (unsigned i = 0; i < list.size(); i++) {
+				list[i]->update();
+			}
+		}
+	}
+	void GameObject::renderAllByType() {
+		for (unsigned type = 0; type < typeRenderLists.size(); type++) {
+			std::vector<Component*>& list = typeRenderLists[type];
+			for (unsigned i = 0; i < list.size(); i++) {
+				list[i]->render();
+			}
+		}
+	}
+	void GameObject::destroyComponent(Component* component) {
+		unlistComponent(component);
+		if (component->worldStorage)
+		{//Archetype owns the memory
+			component->~Component();
+		}
+		else if (component->pool != nullptr)
+		{
+			PoolAllocator* pool = component->pool;
+			component->~Component();
+			pool->free(component);
+		}
+		else
+		{
+			delete component;
+		}
+	}
+	void GameObject::eraseComponent(std::vector<Component*>& list, Component* component) {
+		for (unsigned i = 0; i < list.size(); i++) {
+			if (list[i] == component) {
+				list.erase(list.begin() + i);
+				return;
+			}
+		}
+	}
+	//Removes the component from its type's update and render lists
+	void GameObject::unlistComponent(Component* component) {
+		if (component->updateListIndex != UINT_MAX) {
+			std::vector<Component*>& list = typeUpdateLists[component->typeId];
+			list[component->updateListIndex] = list.back();
+			list[component->updateListIndex]->updateListIndex = component->updateListIndex;
+			list.pop_back();
+			component->updateListIndex = UINT_MAX;
+		}
+		if (component->renderListIndex != UINT_MAX) {
+			std::vector<Component*>& list = typeRenderLists[component->typeId];
+			list[component->renderListIndex] = list.back();
+			list[component->renderListIndex]->renderListIndex = component->renderListIndex;
+			list.pop_back();
+			component->renderListIndex = UINT_MAX;
+		}
+	}
+	void GameObject::attachComponent(Component* component, unsigned typeId, bool updates, bool renders) {
+		component->typeId = typeId;
+		component->threadSafe = component->isThreadSafe();
+		components.push_back(component);
+		component->setGameObject(this);
+
+		//Only components that do something are called
+		if (typeId >= typeUpdateLists.size()) {
+			typeUpdateLists.resize(typeId + 1);
+			typeRenderLists.resize(typeId + 1);
+		}
+		if (updates) {
+			updaters.push_back(component);
+			component->updateListIndex = typeUpdateLists[typeId].size();
+			typeUpdateLists[typeId].push_back(component);
+		}
+		if (renders) {
+			renderers.push_back(component);
+			component->renderListIndex = typeRenderLists[typeId].size();
+			typeRenderLists[typeId].push_back(component);
+		}
+
+		//First component of its type goes to the slot table
+		if (typeId >= componentSlots.size()) {
+			componentSlots.resize(typeId + 1, nullptr);
+		}
+		if (componentSlots[typeId] == nullptr) {
+			componentSlots[typeId] = component;
+			if (typeId < 64) {
+				componentMask |= uint64_t(1) << typeId;
+			}
+		}
+	}
+	void GameObject::refillComponentSlot(unsigned typeId) {
+		//Slot points to the next component of the same type, if there is one
+		componentSlots[typeId] = nullptr;
+		for (unsigned i = 0; i < components.size(); i++) {
+			if (components[i]->typeId == typeId) {
+				componentSlots[typeId] = components[i];
+				return;
+			}
+		}
+		if (typeId < 64) {
+			componentMask &= ~(uint64_t(1) << typeId);
+		}
+	}
+	void GameObject::markTransformsDirty() {
+		if (transformComponent != nullptr)
+			transformComponent->markWorldDirty();
+		else
+			markChildTransformsDirty();
+	}
+	void GameObject::markChildTransformsDirty() {
+		for (unsigned i = 0; i < children.size(); i++) {
+			children[i]->markTransformsDirty();
+		}
+	}
 	Transform& GameObject::transform() {
 		if (transformComponent == nullptr)
 		{
@@ -140,89 +548,114 @@ namespace gines
 	}
 	GameObject* GameObject::createParent() {
 		unparent();
-		parent = new GameObject();
+		(new GameObject())->addChild(this);
 		return parent;
 	}
 	GameObject* GameObject::createParent(std::string parentName) {
 		unparent();
-		parent = new GameObject(parentName);
+		(new GameObject(parentName))->addChild(this);
 		return parent;
 	}
 	void GameObject::setParent(std::string parentName) {
-		unparent();
-		parent = getGameObject(parentName);
+		GameObject* parentObject = getGameObject(parentName);
+		if (parentObject == nullptr)
+			unparent();
+		else
+			parentObject->addChild(this);
 	}
 	void GameObject::setParent(GameObject* parentObject) {
-		unparent();
-		parent = parentObject;
+		if (parentObject == nullptr)
+			unparent();
+		else
+			parentObject->addChild(this);
 	}
 	void GameObject::unparent() {
-		parent = nullptr;
+		if (parent != nullptr)
+			parent->removeChild(this);//Nullifies parent
 	}
 	void GameObject::destroyParent() {
-		delete parent;
+		//Detach first so that the parent doesn't destroy this object as its child
+		GameObject* oldParent = parent;
 		unparent();
+		delete oldParent;
 	}
 	//Children
 	std::vector<GameObject*> GameObject::getChildren() {
 		return children;
 	}
 	GameObject* GameObject::getChild(std::string childName) {
-		for (unsigned i = 0; i < children.size(); i++) {
-			if (children[i]->getNameReference() == childName) {
-				return children[i];
+		//Returns the first child with the name in children order. Scans the children or the objects with the name, whichever is shorter
+		auto it = nameIds.find(childName);
+		if (it == nameIds.end()) {
+			return nullptr;
+		}
+		const unsigned id = it->second;
+		std::vector<GameObject*>& objects = nameEntries[id].objects;
+		if (children.size() <= objects.size()) {
+			for (unsigned i = 0; i < children.size(); i++) {
+				if (children[i]->nameId == id) {
+					return children[i];
+				}
 			}
+			return nullptr;
 		}
-		return nullptr;
+		GameObject* first = nullptr;
+		for (unsigned i = 0; i < objects.size(); i++) {
+			if (objects[i]->parent == this && (first == nullptr || objects[i]->childIndex < first->childIndex)) {
+				first = objects[i];
+			}
+		}
+		return first;
 	}
 	GameObject* GameObject::createChild() {
-		children.push_back(new GameObject());
+		addChild(new GameObject());
 		return children.back();
 	}
 	GameObject* GameObject::createChild(std::string childName) {
-		children.push_back(new GameObject(childName));
+		addChild(new GameObject(childName));
 		return children.back();
 	}
 	void GameObject::addChild(std::string childName) {
-		children.push_back(getGameObject(childName));
-		if (children.back() == nullptr)
-			children.back() = new GameObject(childName);
+		GameObject* childObject = getGameObject(childName);
+		if (childObject == nullptr)
+			childObject = new GameObject(childName);
+		addChild(childObject);
 	}
 	void GameObject::addChild(GameObject* childObject) {
+		if (childObject->parent == this)
+			return;
+		childObject->unparent();
+		childObject->parent = this;
+		childObject->childIndex = children.size();
 		children.push_back(childObject);
+		childObject->markTransformsDirty();
 	}
 	void GameObject::removeChild(std::string childName) {
-		for (unsigned i = 0; i < children.size(); i++) {
-			if (children[i]->getNameReference() == childName) {
-				children.erase(children.begin() + i);
-				return;
-			}
-		}
+		GameObject* childObject = getChild(childName);
+		if (childObject != nullptr)
+			removeChild(childObject);
 	}
 	void GameObject::removeChild(GameObject* childObject) {
-		for (unsigned i = 0; i < children.size(); i++) {
-			if (children[i] == childObject) {
-				children.erase(children.begin() + i);
-				return;
-			}
+		if (childObject->parent != this) {
+			return;
 		}
+		//Swap and pop, the child knows its own position
+		children[childObject->childIndex] = children.back();
+		children[childObject->childIndex]->childIndex = childObject->childIndex;
+		children.pop_back();
+		childObject->parent = nullptr;
+		childObject->markTransformsDirty();
 	}
 	void GameObject::destroyChild(std::string childName) {
-		for (unsigned i = 0; i < children.size(); i++) {
-			if (children[i]->getNameReference() == childName) {
-				delete children[i];
-				children.erase(children.begin() + i);
-				return;
-			}
-		}
+		GameObject* childObject = getChild(childName);
+		if (childObject != nullptr)
+			destroyChild(childObject);
 	}
 	void GameObject::destroyChild(GameObject* childObject) {
-		for (unsigned i = 0; i < children.size(); i++) {
-			if (children[i] == childObject) {
-				delete children[i];
-				children.erase(children.begin() + i);
-				return;
-			}
+		if (childObject->parent != this) {
+			return;
 		}
+		removeChild(childObject);
+		delete childObject;
 	}
 }
\ No newline at end of file
@@ -5,22 +5,62 @@
 #include <unordered_map>
 #include <string>
 #include <memory>
+#include <cstdint>
+#include <type_traits>
 #include "Transform.h"
+#include "Error.hpp"
+#include "Pool.h"
 
 namespace gines
 {
+	class Archetype;
+
+	/*Weak reference to a game object. Resolves to nullptr once the object has been destroyed,
+	even if its memory has been reused by another game object*/
+	struct GameObjectHandle
+	{
+		GameObjectHandle() : index(0), generation(0){}
+		GameObjectHandle(unsigned _index, unsigned _generation) : index(_index), generation(_generation){}
+		bool operator==(const GameObjectHandle& other) const { return index == other.index && generation == other.generation; }
+		bool operator!=(const GameObjectHandle& other) const { return !(*this == other); }
+		unsigned index;
+		unsigned generation;//Generation 0 is never handed out, default constructed handles are null
+	};
+
+	enum class UpdateMode
+	{
+		Serial,			//Depth first walk on the calling thread
+		Parallel,		//Child subtrees are updated as jobs, components that are not thread safe run afterwards in walk order
+		Deterministic	//Same result as Serial, thread safe work between two unsafe components runs in parallel
+	};
+
 	class GameObject
 	{
 	public:
 		static GameObject* getGameObject(std::string gameObjectName);
+		static GameObject* getGameObject(unsigned nameId);//Faster lookup with an interned name id, see getNameId(). Ids are never reused
+		static GameObject* getGameObject(GameObjectHandle handle);//Returns nullptr for stale handles
+		static unsigned getGameObjectCount();//Number of live game objects
 
 		GameObject();
 		GameObject(std::string gameObjectName);
-		~GameObject();
-		//TODO: =operator and copy constructor
+		virtual ~GameObject();//Virtual so that deleting a derived object through a GameObject pointer frees the right size
+		//Game objects created with new are allocated from a pool, derived classes of another size use the global heap
+		static void* operator new(size_t size);
+		static void operator delete(void* pointer, size_t size);
+		//Game objects are copied with a Prefab, see Prefab.h
+		//Reserves registry room for count more game objects
+		static void reserve(unsigned count);
 
-		void update();
+		void update();//Updates components and children according to the update mode
 		void render();
+		void sendCollisionEvent(const CollisionEvent& event);//Passes the event to every component, see ContactEvents.h
+		/*Updates/renders every component of every game object, one component type at a time.
+		Only types that override update()/render() are visited. Order between types follows type registration order*/
+		static void updateAllByType();
+		static void renderAllByType();
+		static void setUpdateMode(UpdateMode mode);
+		static UpdateMode getUpdateMode();
 
 		//------------//
 		// COMPONENTS //
@@ -31,62 +71,80 @@ namespace gines
 		template <typename T>
 		void addComponent()
 		{
-			//Create component
-			T* newComponent = new T();
-			//Check if newComponent is a mono component, if it is then check whether there already is one
-			MonoComponent* mono = dynamic_cast<MonoComponent*>(newComponent);
-			if (mono != nullptr) {
-				//Component is mono component. Check for an existing instance of that component
-				if (getComponent<T>() != nullptr) {
-					//There is already component of this type, return
-					//Error(GameObjectError::MonoComponentFound);
-					delete newComponent;
-					return;
-				}
-				//Error(GameObjectError::AddingMonoComponent);
-
-				//Check if transform
-				Transform* tf = dynamic_cast<Transform*>(newComponent);
-				if (tf != nullptr)
-				{//Set tranform
-					transformComponent = tf;
-				}
+			const unsigned typeId = ComponentType<T>::id();
+			//Check if T is a mono component, if it is then check whether there already is one
+			if (std::is_base_of<MonoComponent, T>::value && hasComponent<T>()) {
+				//There is already component of this type, return
+				//Error(GameObjectError::MonoComponentFound);
+				return;
 			}
-			//Convert the new component pointer (T*) into a Component* pointer
-			Component* cast = dynamic_cast<Component*>(newComponent);
-			components.push_back(cast);
-			cast->setGameObject(this);
+
+			//Create component
+			registerComponentType<T>();
+			PoolAllocator& pool = getPool<T>();
+			T* newComponent = new (pool.allocate()) T();
+			newComponent->pool = &pool;
+			setTransformComponent(newComponent, std::is_base_of<Transform, T>());
+			attachComponent(newComponent, typeId, ComponentOverrides<T>::update, ComponentOverrides<T>::render);
 		}
 
 		/*Returns true if the component was removed. False is returned if component is not found*/
 		template<typename T>
 		bool removeComponent()
 		{
-			T* cast;
-			for (unsigned i = 0; i < components.size(); i++)
-			{
-				cast = dynamic_cast<T*>(components[i]);
-				if (cast != nullptr)
-				{
-					//Check if transform
-					Transform* tf = dynamic_cast<Transform*>(components[i]);
-					if (tf != nullptr)
-					{//Nullify transform pointer
-						transformComponent = nullptr;
-					}
-
-					delete cast;
-					components.erase(components.begin() + i);
-					return true;//Component deleted
-				}
+			Component* component = getComponentDerived<T>();
+			if (component == nullptr) {
+				//Error(GameObjectError::ComponentNotFound);
+				return false;//No component of given type T was found
+			}
+			if (component->worldStorage) {
+				Message("Components stored in a World can only be removed by destroying the game object!", gines::Message::Warning);
+				return false;
+			}
+			eraseComponent(components, component);
+			eraseComponent(updaters, component);
+			eraseComponent(renderers, component);
+			if (component == transformComponent) {
+				//Nullify transform pointer, children now inherit from the next transform up the chain
+				transformComponent = nullptr;
+				markChildTransformsDirty();
+			}
+			if (componentSlots[component->typeId] == component) {
+				refillComponentSlot(component->typeId);
+			}
+			destroyComponent(component);
+			return true;//Component deleted
+		}
+
+		/*Returns true if the object has a component of exactly type T*/
+		template <typename T>
+		bool hasComponent() {
+			const unsigned typeId = ComponentType<T>::id();
+			if (typeId < 64) {
+				return (componentMask & (uint64_t(1) << typeId)) != 0;
 			}
-			//Error(GameObjectError::ComponentNotFound);
-			return false;//No component of given type T was found
+			return typeId < componentSlots.size() && componentSlots[typeId] != nullptr;
 		}
 
-		/*Returns nullptr if no component of given type exists*/
+		/*Returns nullptr if no component of exactly type T exists. Found from the slot table, misses are as cheap as hits.
+		Use getComponentDerived and getComponentsDerived to find components through one of their base classes*/
 		template <typename T>
 		T* getComponent() {
+			const unsigned typeId = ComponentType<T>::id();
+			if (typeId < componentSlots.size()) {
+				return static_cast<T*>(componentSlots[typeId]);
+			}
+			return nullptr;
+		}
+
+		/*Returns nullptr if no component of type T or a type derived from it exists.
+		Tries the slot table first, then scans the components with dynamic_cast*/
+		template <typename T>
+		T* getComponentDerived() {
+			T* exact = getComponent<T>();
+			if (exact != nullptr) {
+				return exact;
+			}
 			T* cast;
 			for (unsigned i = 0; i < components.size(); i++) {
 				cast = dynamic_cast<T*>(components[i]);
@@ -94,14 +152,30 @@ namespace gines
 					return cast;
 				}
 			}
-			//getComponentia kutsutaan MonoObjectin lismisess, niin se tulostaa silloinkin virheen, vaikka mitn virhett ei periaatteessa ole tapahtunut.
 			//Error(GameObjectError::ComponentDoesNotExist);
 			return nullptr;
 		}
 
-		/*Returns nullptr if no components of given type exists*/
+		/*Components of exactly type T, empty if there are none. Like getComponent, subclasses of T are left out*/
 		template <typename T>
 		std::vector<T*> getComponents()
+		{
+			std::vector<T*> _components;
+			if (getComponent<T>() == nullptr) {
+				return _components;
+			}
+			const unsigned typeId = ComponentType<T>::id();
+			for (unsigned i = 0; i < components.size(); i++) {
+				if (components[i]->typeId == typeId) {
+					_components.push_back(static_cast<T*>(components[i]));
+				}
+			}
+			return _components;
+		}
+
+		/*Components of type T or a type derived from it, empty if there are none. Scans the components with dynamic_cast*/
+		template <typename T>
+		std::vector<T*> getComponentsDerived()
 		{
 			std::vector<T*> _components;
 			T* cast;
@@ -113,16 +187,14 @@ namespace gines
 					_components.push_back(cast);
 				}
 			}
-			if (_components.size() == 0) {
-				Error(GameObjectError::ComponentsDoNotExist);//TODO maybe not error level? debug/trace level?
-				return nullptr;
-			}
 			return _components;
 		}
 
-		void rename(std::string newName){ name = newName; }
+		void rename(std::string newName);
 		std::string getName(){ return name; }//Returns value copy
-		std::string& getNameReference(){ return name; }//Returns a reference to value
+		const std::string& getNameReference(){ return name; }//Returns a reference to value. Use rename() to modify
+		unsigned getNameId(){ return nameId; }//Interned id of the name, shared by all objects with the same name
+		GameObjectHandle getHandle();
 
 		//-----------------//
 		// RELATED OBJECTS //
@@ -150,14 +222,87 @@ namespace gines
 
 		//Public members
 		Transform& transform();
+		bool hasTransform(){ return transformComponent != nullptr; }
 
 	private:
+		friend class World;
+		friend class Transform;
+		friend class Prefab;
+
+		//What the engine knows about a component type, filled when the type is first added to an object
+		struct ComponentTypeInfo
+		{
+			ComponentCloneFunction clone = nullptr;//nullptr if the type can't be copied
+			PoolAllocator* pool = nullptr;
+			bool updates = false;
+			bool renders = false;
+			bool transform = false;//Derived from Transform
+		};
+		static ComponentTypeInfo& getComponentTypeInfo(unsigned typeId);
+		template <typename T>
+		static void registerComponentType()
+		{
+			static bool registered = false;
+			if (registered)
+				return;
+			registered = true;
+			ComponentTypeInfo& info = getComponentTypeInfo(ComponentType<T>::id());
+			info.clone = ComponentCloner<T>::get();
+			info.pool = &getPool<T>();
+			info.updates = ComponentOverrides<T>::update;
+			info.renders = ComponentOverrides<T>::render;
+			info.transform = std::is_base_of<Transform, T>::value;
+		}
+		//Creates an object with the name of an interned name id, skipping the name lookup
+		struct InternedName
+		{
+			explicit InternedName(unsigned _id) : id(_id){}
+			unsigned id;
+		};
+		explicit GameObject(InternedName internedName);
+		static void reserveName(unsigned nameId, unsigned count);
+
+		void indexName();
+		void unindexName();
+		void registerObject();
+		void unregisterObject();
+		void setTransformComponent(Transform* tf, std::true_type){ transformComponent = tf; markChildTransformsDirty(); }
+		void setTransformComponent(Component*, std::false_type){}
+		void attachComponent(Component* component, unsigned typeId, bool updates, bool renders);
+		static void unlistComponent(Component* component);
+		static void destroyComponent(Component* component);
+		static void eraseComponent(std::vector<Component*>& list, Component* component);
+		void refillComponentSlot(unsigned typeId);
+		void markTransformsDirty();//This object's transform, or the closest transforms below it
+		void markChildTransformsDirty();
+		struct UpdateTask;
+		void updateSerial();
+		void updateParallel();
+		void updateDeterministic();
+		void updateCollect(std::vector<Component*>& deferred);
+		bool markUpdateSafety();
+		void scheduleUpdate(std::vector<UpdateTask>& pending);
+		static void runUpdateTasks(std::vector<UpdateTask>& tasks);
+
 		std::string name;
+		unsigned nameId;	//Index to the name table
+		unsigned nameSlot;	//Position in the name table entry's object list
+		unsigned registrySlot;	//Index of the handle slot
+		unsigned childIndex = 0;//Position in parent's children vector
 		GameObject* parent = nullptr;
-		Transform* transformComponent;
+		Transform* transformComponent = nullptr;
+		Archetype* archetype = nullptr;	//Set when created by a World
+		unsigned archetypeRow = 0;
+		bool subtreeUpdateSafe = false;//Set by markUpdateSafety: no component in this subtree is unsafe to update in parallel
 
 		//Memory responsibilities
 		std::vector<GameObject*> children;
 		std::vector<Component*> components;
+		std::vector<Component*> updaters;//Components whose type overrides update(), in component order
+		std::vector<Component*> renderers;//Components whose type overrides render()
+
+		//Component lookup
+		uint64_t componentMask = 0;//Bit for each component type id below 64
+		std::vector<Component*> componentSlots;//First component of each type, indexed by type id
 	};
 }
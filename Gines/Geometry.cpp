@@ -1,4 +1,5 @@
 #include "Geometry.h"
+#include <cfloat>
 
 namespace gines
 {
@@ -21,4 +22,70 @@ namespace gines
 	{
 		return sqrt(vec.x*vec.x + vec.y*vec.y);
 	}
-}
\ No newline at end of file
+
+	//Half length of box projected on the unit axis (x, y)
+	static float projectedRadius(const OrientedBox& box, float x, float y)
+	{
+		return box.halfSize.x * fabsf(box.axis.x * x + box.axis.y * y) + box.halfSize.y * fabsf(box.axis.x * y - box.axis.y * x);
+	}
+	bool OrientedBox::overlaps(const OrientedBox& other, glm::vec2& normal, float& depth) const
+	{
+		//The batched narrowphase does the same steps in the same order, keep them in sync
+		const float axesX[4] = { axis.x, -axis.y, other.axis.x, -other.axis.y };
+		const float axesY[4] = { axis.y, axis.x, other.axis.y, other.axis.x };
+		const float dx = other.center.x - center.x;
+		const float dy = other.center.y - center.y;
+		float bestDepth = FLT_MAX;
+		for (int i = 0; i < 4; i++)
+		{
+			const float distance = dx * axesX[i] + dy * axesY[i];
+			const float overlap = projectedRadius(*this, axesX[i], axesY[i]) + projectedRadius(other, axesX[i], axesY[i]) - fabsf(distance);
+			if (overlap < 0.0f)
+				return false;
+			if (overlap < bestDepth)
+			{
+				bestDepth = overlap;
+				normal = distance < 0.0f ? glm::vec2(-axesX[i], -axesY[i]) : glm::vec2(axesX[i], axesY[i]);
+			}
+		}
+		depth = bestDepth;
+		return true;
+	}
+	bool OrientedBox::sweep(const OrientedBox& moving, glm::vec2 displacement, float& fraction) const
+	{//On each separating axis the projections overlap during one interval of the move, the boxes touch where all intervals meet
+		const float axesX[4] = { axis.x, -axis.y, moving.axis.x, -moving.axis.y };
+		const float axesY[4] = { axis.y, axis.x, moving.axis.y, moving.axis.x };
+		const float dx = moving.center.x - center.x;
+		const float dy = moving.center.y - center.y;
+		float enter = 0.0f;
+		float exit = 1.0f;
+		for (int i = 0; i < 4; i++)
+		{
+			const float distance = dx * axesX[i] + dy * axesY[i];
+			const float speed = displacement.x * axesX[i] + displacement.y * axesY[i];
+			const float radius = projectedRadius(*this, axesX[i], axesY[i]) + projectedRadius(moving, axesX[i], axesY[i]);
+			if (speed == 0.0f)
+			{
+				if (fabsf(distance) > radius)
+					return false;
+				continue;
+			}
+			float t1 = (-radius - distance) / speed;
+			float t2 = (radius - distance) / speed;
+			if (t1 > t2)
+			{
+				const float temp = t1;
+				t1 = t2;
+				t2 = temp;
+			}
+			if (t1 > enter)
+				enter = t1;
+			if (t2 < exit)
+				exit = t2;
+			if (enter > exit)
+				return false;
+		}
+		fraction = enter;
+		return true;
+	}
+}
@@ -7,4 +7,106 @@ namespace gines
 	glm::vec2 rotatePoint(glm::vec2& point, float rotation);
 	glm::vec2 rotatePoint(float x, float y, float rotation);
 	float getMagnitude(glm::vec2& vec);
-}
\ No newline at end of file
+
+	//Axis aligned bounding box in world coordinates. Touching edges count as overlapping, like CollisionBox::isColliding
+	struct AABB
+	{
+		AABB() : min(0, 0), max(0, 0){}
+		AABB(glm::vec2 _min, glm::vec2 _max) : min(_min), max(_max){}
+
+		bool overlaps(const AABB& other) const
+		{
+			return !(max.x < other.min.x || min.x > other.max.x || max.y < other.min.y || min.y > other.max.y);
+		}
+		bool contains(glm::vec2 point) const
+		{
+			return !(point.x < min.x || point.x > max.x || point.y < min.y || point.y > max.y);
+		}
+		bool contains(const AABB& other) const
+		{
+			return other.min.x >= min.x && other.min.y >= min.y && other.max.x <= max.x && other.max.y <= max.y;
+		}
+		AABB merged(const AABB& other) const
+		{
+			return AABB(glm::vec2(min.x < other.min.x ? min.x : other.min.x, min.y < other.min.y ? min.y : other.min.y),
+				glm::vec2(max.x > other.max.x ? max.x : other.max.x, max.y > other.max.y ? max.y : other.max.y));
+		}
+		AABB expanded(float margin) const
+		{
+			return AABB(glm::vec2(min.x - margin, min.y - margin), glm::vec2(max.x + margin, max.y + margin));
+		}
+		float perimeter() const
+		{
+			return 2.0f * ((max.x - min.x) + (max.y - min.y));
+		}
+		//Segment from -> to. On hit, fraction is the first point inside along the segment, 0 if from is inside
+		bool intersectsSegment(glm::vec2 from, glm::vec2 to, float& fraction) const
+		{
+			float enter = 0.0f;
+			float exit = 1.0f;
+			if (!clipSlab(from.x, to.x - from.x, min.x, max.x, enter, exit) || !clipSlab(from.y, to.y - from.y, min.y, max.y, enter, exit))
+				return false;
+			fraction = enter;
+			return true;
+		}
+		//Box moving moved by displacement. On hit, fraction is where it first touches this box along the way, 0 if they overlap at the start
+		bool sweep(const AABB& moving, glm::vec2 displacement, float& fraction) const
+		{//Same as a segment from the center of moving against this box grown by the half size of moving
+			const glm::vec2 halfSize = (moving.max - moving.min) * 0.5f;
+			const glm::vec2 center = (moving.min + moving.max) * 0.5f;
+			return AABB(min - halfSize, max + halfSize).intersectsSegment(center, center + displacement, fraction);
+		}
+
+		glm::vec2 min;
+		glm::vec2 max;
+
+	private:
+		static bool clipSlab(float from, float delta, float slabMin, float slabMax, float& enter, float& exit)
+		{
+			if (delta == 0.0f)
+				return from >= slabMin && from <= slabMax;
+			float t1 = (slabMin - from) / delta;
+			float t2 = (slabMax - from) / delta;
+			if (t1 > t2)
+			{
+				float temp = t1;
+				t1 = t2;
+				t2 = temp;
+			}
+			if (t1 > enter)
+				enter = t1;
+			if (t2 < exit)
+				exit = t2;
+			return enter <= exit;
+		}
+	};
+
+	//Rotated rectangle in world coordinates
+	struct OrientedBox
+	{
+		OrientedBox() : center(0, 0), axis(1, 0), halfSize(0, 0){}
+
+		//Bounds of the rotated corners
+		AABB getBounds() const
+		{
+			const float extentX = fabsf(axis.x) * halfSize.x + fabsf(axis.y) * halfSize.y;
+			const float extentY = fabsf(axis.y) * halfSize.x + fabsf(axis.x) * halfSize.y;
+			return AABB(glm::vec2(center.x - extentX, center.y - extentY), glm::vec2(center.x + extentX, center.y + extentY));
+		}
+		bool contains(glm::vec2 point) const
+		{
+			const float dx = point.x - center.x;
+			const float dy = point.y - center.y;
+			return fabsf(dx * axis.x + dy * axis.y) <= halfSize.x && fabsf(dy * axis.x - dx * axis.y) <= halfSize.y;
+		}
+		/*Separating axis test, touching counts as overlapping.
+		On overlap, normal is the axis of least penetration pointing from this box towards other, and depth is the penetration along it*/
+		bool overlaps(const OrientedBox& other, glm::vec2& normal, float& depth) const;
+		//Box moving moved by displacement without rotating. On hit, fraction is where it first touches this box along the way, 0 if they overlap at the start
+		bool sweep(const OrientedBox& moving, glm::vec2 displacement, float& fraction) const;
+
+		glm::vec2 center;
+		glm::vec2 axis;//Unit x axis of the box, the y axis is this rotated 90 degrees counter clockwise
+		glm::vec2 halfSize;
+	};
+}
@@ -1,6 +1,15 @@
 #include "Gines.h"
 #include "Time.h"
 #include "Camera.h"
+#include "Transform.h"
+#include "Profiler.h"
+#include "ConsoleInput.h"
+#include "CommandBuffer.h"
+#include "JobSystem.h"
+#include "Broadphase.h"
+#include "CollisionBenchmark.h"
+#include "ContactEvents.h"
+#include "PhysicsWorld.h"
 
 #include <SDL/SDL.h>
 #include <GL/glew.h>
@@ -49,6 +58,12 @@ namespace gines
 			return false;
 		}
 
+		if (!gines::initializeJobs())
+		{
+			Message("Initialization failed! Failed to initialize job system!", gines::Message::Fatal);
+			return false;
+		}
+
 		if (!gines::initializeTime())
 		{
 			Message("Initialization failed! Failed to initialize time!", gines::Message::Fatal);
@@ -61,6 +76,14 @@ namespace gines
 			return false;
 		}
 
+		if (!gines::initializeProfiler())
+		{
+			Message("Initialization failed! Failed to initialize profiler!", gines::Message::Fatal);
+			return false;
+		}
+		addCollisionBenchmarkCommand();
+		initializePhysics();
+
 		//GUI camera instance initialization
 		guiCamera.setViewport(glm::vec2(0, 0), glm::vec2(WINDOW_WIDTH, WINDOW_HEIGHT));
 		guiCamera.setPosition(WINDOW_WIDTH / 2, WINDOW_HEIGHT / 2);
@@ -93,9 +116,12 @@ namespace gines
 
 	int uninitialize()
 	{
+		stopConsoleInput();
 		uninitializeTime();
+		uninitializeProfiler();
 		console.unitialize();
 		uninitializeTextRendering();
+		uninitializeJobs();
 
 		Message("Exited succesfully", gines::Message::Info);
 		std::getchar();
@@ -104,16 +130,27 @@ namespace gines
 
 	void beginMainLoop()
 	{
+		beginProfilerFrame();
+		Transform::clearMovedTransforms();
 		beginFPS();
 		glClear(GL_COLOR_BUFFER_BIT);
 		inputManager.update();
 		console.update();
+		pollConsoleInput();
+		runMainThreadJobs();
+		updatePhysics(deltaTime / 1000.0f);
+		updateBroadphase();
+		updateContacts();
 		guiCamera.update();
 	}
 	void endMainLoop()
 	{
+		//Sync point for structural changes recorded during the frame
+		frameCommands.apply();
 		console.render();
 		drawFPS();
+		endProfilerFrame();
+		drawProfiler();
 		SDL_GL_SwapWindow(mWindow);
 		endFPS();
 	}
@@ -0,0 +1,296 @@
+#include <thread>
+#include <deque>
+#include <chrono>
+#include <condition_variable>
+#include <string>
+
+#include "JobSystem.h"
+#include "Error.hpp"
+
+#ifdef _MSC_VER
+#define GINES_THREAD_LOCAL __declspec(thread)
+#else
+#define GINES_THREAD_LOCAL thread_local
+#endif
+
+#define JOB_IDLE_WAIT_MS 2	//Upper limit for how long an idle worker sleeps before looking for work again
+
+namespace gines
+{
+	struct WorkerQueue
+	{
+		std::mutex mutex;
+		std::deque<JobEntry> jobs;
+	};
+
+	//Local variables
+	static bool initialized = false;
+	static std::vector<std::thread> workers;
+	static std::vector<WorkerQueue*> queues;//One per worker and the last one for jobs submitted from other threads
+	static std::atomic<bool> running(false);
+	static std::atomic<int> queuedJobs(0);
+	static std::mutex sleepMutex;
+	static std::condition_variable wakeUp;
+	static std::mutex mainQueueMutex;
+	static std::vector<JobEntry> mainQueue;
+	static std::thread::id mainThreadId;
+	static GINES_THREAD_LOCAL int workerIndex = -1;//-1 on threads that are not workers
+
+	void executeJob(JobEntry& entry)
+	{
+		entry.job();
+		if (entry.counter != nullptr)
+		{
+			entry.counter->decrement();
+		}
+	}
+
+	static void pushJob(JobEntry& entry)
+	{
+		WorkerQueue* queue = workerIndex >= 0 ? queues[workerIndex] : queues.back();
+		{
+			std::lock_guard<std::mutex> lock(queue->mutex);
+			queue->jobs.push_back(entry);
+		}
+		queuedJobs++;
+		wakeUp.notify_one();
+	}
+
+	//Runs the entry right away if there are no workers
+	static void scheduleJob(JobEntry& entry)
+	{
+		if (initialized)
+			pushJob(entry);
+		else
+			executeJob(entry);
+	}
+
+	static bool popJob(WorkerQueue* queue, bool back, JobEntry& entry)
+	{
+		std::lock_guard<std::mutex> lock(queue->mutex);
+		if (queue->jobs.empty())
+			return false;
+		if (back)
+		{
+			entry = queue->jobs.back();
+			queue->jobs.pop_back();
+		}
+		else
+		{
+			entry = queue->jobs.front();
+			queue->jobs.pop_front();
+		}
+		queuedJobs--;
+		return true;
+	}
+
+	/*Own deque first (newest job), then the shared queue and then steal the oldest job of another worker*/
+	static bool findJob(JobEntry& entry)
+	{
+		if (queuedJobs.load() <= 0)
+			return false;
+		const int count = queues.size();
+		const int own = workerIndex >= 0 ? workerIndex : count - 1;
+		if (popJob(queues[own], true, entry))
+			return true;
+		if (own != count - 1 && popJob(queues[count - 1], false, entry))
+			return true;
+		for (int i = 1; i < count; i++)
+		{
+			int victim = (own + i) % count;
+			if (popJob(queues[victim], false, entry))
+				return true;
+		}
+		return false;
+	}
+
+	static void workerLoop(int index)
+	{
+		workerIndex = index;
+		JobEntry entry;
+		while (running.load())
+		{
+			if (findJob(entry))
+			{
+				executeJob(entry);
+				entry = JobEntry();
+			}
+			else
+			{
+				std::unique_lock<std::mutex> lock(sleepMutex);
+				wakeUp.wait_for(lock, std::chrono::milliseconds(JOB_IDLE_WAIT_MS));
+			}
+		}
+	}
+
+	void JobCounter::decrement()
+	{
+		//Locked so that waitForCounter cannot return (and the counter be destroyed) before this is done with it
+		std::vector<JobEntry> released;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (count.fetch_sub(1) != 1)
+				return;
+			//Reached zero, release the dependent jobs
+			released.swap(dependents);
+		}
+		for (unsigned i = 0; i < released.size(); i++)
+		{
+			scheduleJob(released[i]);
+		}
+	}
+
+	bool initializeJobs(unsigned workerCount)
+	{
+		Message("Job system initialization started...", gines::Message::Info);
+		if (initialized)
+		{
+			Message("Job system already initialized!", gines::Message::Info);
+			return true;
+		}
+		if (workerCount == 0)
+		{
+			unsigned hardwareThreads = std::thread::hardware_concurrency();
+			workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+		}
+
+		mainThreadId = std::this_thread::get_id();
+		for (unsigned i = 0; i <= workerCount; i++)
+		{
+			queues.push_back(new WorkerQueue());
+		}
+		running.store(true);
+		for (unsigned i = 0; i < workerCount; i++)
+		{
+			workers.push_back(std::thread(workerLoop, int(i)));
+		}
+
+		initialized = true;
+		Message(("Job system initialized with " + std::to_string(workerCount) + " workers").c_str(), gines::Message::Info);
+		return true;
+	}
+	void uninitializeJobs()
+	{
+		if (!initialized)
+		{
+			return;
+		}
+		running.store(false);
+		wakeUp.notify_all();
+		for (unsigned i = 0; i < workers.size(); i++)
+		{
+			workers[i].join();
+		}
+		workers.clear();
+
+		//Finish whatever is left so that counters reach zero
+		runMainThreadJobs();
+		JobEntry entry;
+		while (findJob(entry))
+		{
+			executeJob(entry);
+		}
+
+		for (unsigned i = 0; i < queues.size(); i++)
+		{
+			delete queues[i];
+		}
+		queues.clear();
+		initialized = false;
+	}
+	unsigned getWorkerCount()
+	{
+		return workers.size();
+	}
+	bool isMainThread()
+	{
+		return std::this_thread::get_id() == mainThreadId;
+	}
+
+	void runJob(Job job, JobCounter* counter)
+	{
+		if (counter != nullptr)
+			counter->increment();
+		JobEntry entry(job, counter);
+		scheduleJob(entry);
+	}
+	void runMainThreadJob(Job job, JobCounter* counter)
+	{
+		if (counter != nullptr)
+			counter->increment();
+		std::lock_guard<std::mutex> lock(mainQueueMutex);
+		mainQueue.push_back(JobEntry(job, counter));
+	}
+	void runJobAfter(JobCounter& dependency, Job job, JobCounter* counter)
+	{
+		if (counter != nullptr)
+			counter->increment();
+		{
+			std::lock_guard<std::mutex> lock(dependency.mutex);
+			if (!dependency.isDone())
+			{//Queued by JobCounter::decrement
+				dependency.dependents.push_back(JobEntry(job, counter));
+				return;
+			}
+		}
+		JobEntry entry(job, counter);
+		scheduleJob(entry);
+	}
+	void runMainThreadJobs()
+	{
+		std::vector<JobEntry> jobs;
+		{
+			std::lock_guard<std::mutex> lock(mainQueueMutex);
+			jobs.swap(mainQueue);
+		}
+		for (unsigned i = 0; i < jobs.size(); i++)
+		{
+			executeJob(jobs[i]);
+		}
+	}
+	void waitForCounter(JobCounter& counter)
+	{
+		const bool mainThread = isMainThread();
+		JobEntry entry;
+		while (!counter.isDone())
+		{
+			if (mainThread)
+			{
+				runMainThreadJobs();
+			}
+			if (initialized && findJob(entry))
+			{
+				executeJob(entry);
+				entry = JobEntry();
+			}
+			else
+			{
+				std::this_thread::yield();
+			}
+		}
+		//Wait for the last decrement to release the counter
+		std::lock_guard<std::mutex> lock(counter.mutex);
+	}
+
+	void parallelFor(unsigned begin, unsigned end, unsigned grainSize, std::function<void(unsigned, unsigned)> function)
+	{
+		if (begin >= end)
+			return;
+		if (grainSize == 0)
+			grainSize = 1;
+		if (!initialized || end - begin <= grainSize)
+		{
+			function(begin, end);
+			return;
+		}
+		JobCounter counter;
+		//The calling thread takes the first range itself
+		for (unsigned rangeBegin = begin + grainSize; rangeBegin < end; rangeBegin += grainSize)
+		{
+			unsigned rangeEnd = rangeBegin + grainSize < end ? rangeBegin + grainSize : end;
+			runJob([&function, rangeBegin, rangeEnd](){ function(rangeBegin, rangeEnd); }, &counter);
+		}
+		function(begin, begin + grainSize);
+		waitForCounter(counter);
+	}
+}
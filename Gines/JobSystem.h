@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <functional>
+
+/*
+Work stealing job system. Started by gines::initialize() and stopped by gines::uninitialize().
+
+	gines::JobCounter counter;
+	gines::runJob([](){ ... }, &counter);
+	gines::runJob([](){ ... }, &counter);
+	gines::runJobAfter(counter, [](){ ... });//Runs once both jobs above are done
+	gines::waitForCounter(counter);
+
+	gines::parallelFor(0, count, 64, [&](unsigned begin, unsigned end){ ... });
+
+Each worker has its own job deque. Jobs submitted from a worker go to its own deque and are taken
+from the back (most recent first), idle workers steal from the front of other deques.
+Jobs that call OpenGL must be submitted with runMainThreadJob, they run on the main thread at the start
+of the frame or while the main thread waits for a counter.
+*/
+namespace gines
+{
+	typedef std::function<void()> Job;
+	class JobCounter;
+
+	struct JobEntry
+	{
+		JobEntry() : counter(nullptr){}
+		JobEntry(Job _job, JobCounter* _counter) : job(_job), counter(_counter){}
+		Job job;
+		JobCounter* counter;//Decremented when the job has finished, can be nullptr
+	};
+
+	/*Number of unfinished jobs associated with it. Jobs can be made to depend on a counter with runJobAfter.
+	Must outlive the jobs that use it, call waitForCounter before destroying it.*/
+	class JobCounter
+	{
+	public:
+		JobCounter() : count(0){}
+		bool isDone(){ return count.load() == 0; }
+	private:
+		friend void runJob(Job job, JobCounter* counter);
+		friend void runMainThreadJob(Job job, JobCounter* counter);
+		friend void runJobAfter(JobCounter& dependency, Job job, JobCounter* counter);
+		friend void executeJob(JobEntry& entry);
+		friend void waitForCounter(JobCounter& counter);
+		JobCounter(const JobCounter&);
+		void operator=(const JobCounter&);
+		void increment(){ count++; }
+		void decrement();
+
+		std::atomic<int> count;
+		std::mutex mutex;
+		std::vector<JobEntry> dependents;//Jobs waiting for this counter to reach zero
+	};
+
+	bool initializeJobs(unsigned workerCount = 0);//0 uses one worker per hardware thread, minus the main thread
+	void uninitializeJobs();
+	unsigned getWorkerCount();
+	bool isMainThread();
+
+	void runJob(Job job, JobCounter* counter = nullptr);
+	void runMainThreadJob(Job job, JobCounter* counter = nullptr);
+	void runJobAfter(JobCounter& dependency, Job job, JobCounter* counter = nullptr);
+	//Runs other jobs while waiting, the main thread also runs main thread jobs
+	void waitForCounter(JobCounter& counter);
+	//Splits [begin, end) into ranges of grainSize and calls function(rangeBegin, rangeEnd) for each range in parallel. Returns when all ranges are done
+	void parallelFor(unsigned begin, unsigned end, unsigned grainSize, std::function<void(unsigned, unsigned)> function);
+	//Runs the queued main thread jobs, called from beginMainLoop()
+	void runMainThreadJobs();
+}
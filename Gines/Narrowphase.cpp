@@ -0,0 +1,122 @@
+#include "Narrowphase.h"
+#include "CollisionBox.h"
+#include "Simd.h"
+#include <cfloat>
+
+namespace gines
+{
+#ifdef GINES_SSE2
+	static inline __m128 selectPs(__m128 mask, __m128 a, __m128 b)
+	{
+		return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+	}
+	//Same steps as projectedRadius() in Geometry.cpp
+	static inline __m128 projectedRadiusPs(__m128 halfX, __m128 halfY, __m128 axisX, __m128 axisY, __m128 x, __m128 y, __m128 absMask)
+	{
+		__m128 alongX = _mm_and_ps(_mm_add_ps(_mm_mul_ps(axisX, x), _mm_mul_ps(axisY, y)), absMask);
+		__m128 alongY = _mm_and_ps(_mm_sub_ps(_mm_mul_ps(axisX, y), _mm_mul_ps(axisY, x)), absMask);
+		return _mm_add_ps(_mm_mul_ps(halfX, alongX), _mm_mul_ps(halfY, alongY));
+	}
+#endif
+
+	void findContacts(const std::vector<CollisionPair>& pairs, std::vector<Contact>& contacts)
+	{
+		const unsigned count = pairs.size();
+		unsigned p = 0;
+#ifdef GINES_SSE2
+		const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+		const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32(0x80000000));
+		const __m128 zero = _mm_setzero_ps();
+		//Four pairs per iteration, one per lane
+		float centerAX[4], centerAY[4], axisAX[4], axisAY[4], halfAX[4], halfAY[4];
+		float centerBX[4], centerBY[4], axisBX[4], axisBY[4], halfBX[4], halfBY[4];
+		float normalX[4], normalY[4], depth[4];
+		for (; p + 4 <= count; p += 4)
+		{
+			for (int lane = 0; lane < 4; lane++)
+			{
+				const OrientedBox& a = pairs[p + lane].a->getOrientedBox();
+				const OrientedBox& b = pairs[p + lane].b->getOrientedBox();
+				centerAX[lane] = a.center.x;
+				centerAY[lane] = a.center.y;
+				axisAX[lane] = a.axis.x;
+				axisAY[lane] = a.axis.y;
+				halfAX[lane] = a.halfSize.x;
+				halfAY[lane] = a.halfSize.y;
+				centerBX[lane] = b.center.x;
+				centerBY[lane] = b.center.y;
+				axisBX[lane] = b.axis.x;
+				axisBY[lane] = b.axis.y;
+				halfBX[lane] = b.halfSize.x;
+				halfBY[lane] = b.halfSize.y;
+			}
+			const __m128 aX = _mm_loadu_ps(axisAX);
+			const __m128 aY = _mm_loadu_ps(axisAY);
+			const __m128 bX = _mm_loadu_ps(axisBX);
+			const __m128 bY = _mm_loadu_ps(axisBY);
+			const __m128 hAX = _mm_loadu_ps(halfAX);
+			const __m128 hAY = _mm_loadu_ps(halfAY);
+			const __m128 hBX = _mm_loadu_ps(halfBX);
+			const __m128 hBY = _mm_loadu_ps(halfBY);
+			const __m128 dx = _mm_sub_ps(_mm_loadu_ps(centerBX), _mm_loadu_ps(centerAX));
+			const __m128 dy = _mm_sub_ps(_mm_loadu_ps(centerBY), _mm_loadu_ps(centerAY));
+
+			//Axes of a, then b
+			const __m128 axesX[4] = { aX, _mm_xor_ps(aY, signMask), bX, _mm_xor_ps(bY, signMask) };
+			const __m128 axesY[4] = { aY, aX, bY, bX };
+			__m128 best = _mm_set1_ps(FLT_MAX);
+			__m128 bestX = zero;
+			__m128 bestY = zero;
+			__m128 separated = zero;
+			for (int i = 0; i < 4; i++)
+			{
+				const __m128 distance = _mm_add_ps(_mm_mul_ps(dx, axesX[i]), _mm_mul_ps(dy, axesY[i]));
+				const __m128 radii = _mm_add_ps(projectedRadiusPs(hAX, hAY, aX, aY, axesX[i], axesY[i], absMask),
+					projectedRadiusPs(hBX, hBY, bX, bY, axesX[i], axesY[i], absMask));
+				const __m128 overlap = _mm_sub_ps(radii, _mm_and_ps(distance, absMask));
+				separated = _mm_or_ps(separated, _mm_cmplt_ps(overlap, zero));
+				const __m128 better = _mm_cmplt_ps(overlap, best);
+				const __m128 flip = _mm_and_ps(_mm_cmplt_ps(distance, zero), signMask);
+				best = selectPs(better, overlap, best);
+				bestX = selectPs(better, _mm_xor_ps(axesX[i], flip), bestX);
+				bestY = selectPs(better, _mm_xor_ps(axesY[i], flip), bestY);
+			}
+
+			const int hits = ~_mm_movemask_ps(separated) & 0xf;
+			if (hits == 0)
+				continue;
+			_mm_storeu_ps(normalX, bestX);
+			_mm_storeu_ps(normalY, bestY);
+			_mm_storeu_ps(depth, best);
+			for (int lane = 0; lane < 4; lane++)
+			{
+				if (hits & (1 << lane))
+				{
+					Contact contact;
+					contact.a = pairs[p + lane].a;
+					contact.b = pairs[p + lane].b;
+					contact.normal = glm::vec2(normalX[lane], normalY[lane]);
+					contact.depth = depth[lane];
+					contacts.push_back(contact);
+				}
+			}
+		}
+#endif
+		for (; p < count; p++)
+		{
+			Contact contact;
+			if (pairs[p].a->isColliding(*pairs[p].b, contact.normal, contact.depth))
+			{
+				contact.a = pairs[p].a;
+				contact.b = pairs[p].b;
+				contacts.push_back(contact);
+			}
+		}
+	}
+	void findContacts(std::vector<Contact>& contacts)
+	{
+		std::vector<CollisionPair> pairs;
+		getBroadphase()->queryPairs(pairs);
+		findContacts(pairs, contacts);
+	}
+}
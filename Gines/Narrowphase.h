@@ -0,0 +1,29 @@
+#pragma once
+
+#include <vector>
+#include <glm/vec2.hpp>
+#include "Broadphase.h"
+
+/*
+Narrowphase tests the candidate pairs from the broadphase with the rotated boxes:
+
+	std::vector<gines::Contact> contacts;
+	gines::findContacts(contacts);
+	for (auto& contact : contacts)
+		separate(contact.a, contact.b, contact.normal * contact.depth);//Moving b by normal * depth pushes it out of a
+*/
+namespace gines
+{
+	struct Contact
+	{
+		CollisionBox* a;
+		CollisionBox* b;
+		glm::vec2 normal;//Unit axis of least penetration, pointing from a towards b
+		float depth;
+	};
+
+	//Tests the pairs four at a time with SSE2, appends a contact for each pair that collides
+	void findContacts(const std::vector<CollisionPair>& pairs, std::vector<Contact>& contacts);
+	//Queries the pairs from the active broadphase first
+	void findContacts(std::vector<Contact>& contacts);
+}
@@ -0,0 +1,529 @@
+#include "NavigationGrid.h"
+#include "PhysicsComponent.h"
+#include "PhysicsWorld.h"
+#include "CollisionBox.h"
+#include "GameObject.h"
+#include <algorithm>
+#include <functional>
+#include <cmath>
+
+#define NAVIGATION_CELL_EPSILON 0.001f	//Fraction of a cell that boxes must reach past its edge to block it, boxes touching an edge don't
+#define NAVIGATION_DIAGONAL_COST 1.41421356f
+
+namespace gines
+{
+	void PathSearch::prepare(unsigned cellCount)
+	{
+		if (cost.size() != cellCount)
+		{
+			cost.assign(cellCount, 0.0f);
+			parent.assign(cellCount, 0);
+			visited.assign(cellCount, 0);
+			closed.assign(cellCount, 0);
+			stamp = 0;
+		}
+		stamp++;
+		if (stamp == 0)
+		{//Wrapped around, old stamps could match again
+			std::fill(visited.begin(), visited.end(), 0);
+			std::fill(closed.begin(), closed.end(), 0);
+			stamp = 1;
+		}
+		open.clear();
+		cells.clear();
+	}
+
+	NavigationGrid::NavigationGrid(const AABB& _area, float _cellSize, unsigned _obstacleLayers) : area(_area), cellSize(_cellSize), obstacleLayers(_obstacleLayers)
+	{
+		columns = std::max(1, int(ceilf((area.max.x - area.min.x) / cellSize)));
+		rows = std::max(1, int(ceilf((area.max.y - area.min.y) / cellSize)));
+		blocked.assign(columns * rows, 0);
+	}
+	NavigationGrid::~NavigationGrid()
+	{
+	}
+
+	bool NavigationGrid::isObstacle(CollisionBox* box)
+	{
+		GameObject* object = box->getGameObject();
+		return (box->getLayers() & obstacleLayers) != 0 && object != nullptr && getPhysicsWorld().findComponent(object) == nullptr;
+	}
+
+	bool NavigationGrid::update()
+	{
+		changedRects.clear();
+
+		//Find the obstacles that appeared, moved or went away. The oriented box is compared rather than
+		//checkMoved(), which belongs to updateBroadphase()
+		scan++;
+		for (unsigned i = 0; i < collisionBoxes.size(); i++)
+		{
+			CollisionBox* box = collisionBoxes[i];
+			if (!isObstacle(box))
+				continue;
+			const OrientedBox& orientedBox = box->getOrientedBox();
+			auto found = obstacleIndices.find(box);
+			if (found == obstacleIndices.end())
+			{
+				obstacleIndices[box] = obstacles.size();
+				Obstacle obstacle = { box, orientedBox, scan };
+				obstacles.push_back(obstacle);
+				dirtyRects.push_back(orientedBox.getBounds());
+				continue;
+			}
+			Obstacle& obstacle = obstacles[found->second];
+			obstacle.scan = scan;
+			if (obstacle.orientedBox.center != orientedBox.center || obstacle.orientedBox.axis != orientedBox.axis || obstacle.orientedBox.halfSize != orientedBox.halfSize)
+			{
+				dirtyRects.push_back(obstacle.orientedBox.getBounds());
+				dirtyRects.push_back(orientedBox.getBounds());
+				obstacle.orientedBox = orientedBox;
+			}
+		}
+		for (unsigned i = 0; i < obstacles.size();)
+		{
+			if (obstacles[i].scan == scan)
+			{
+				i++;
+				continue;
+			}
+			//Destroyed, or no longer an obstacle
+			dirtyRects.push_back(obstacles[i].orientedBox.getBounds());
+			obstacleIndices.erase(obstacles[i].box);
+			obstacles[i] = obstacles.back();
+			obstacles.pop_back();
+			if (i < obstacles.size())
+				obstacleIndices[obstacles[i].box] = i;
+		}
+
+		if (dirtyRects.empty())
+			return false;
+
+		//Rebuilt cells are found through the broadphase, which has to know about the new obstacles
+		updateBroadphase();
+		for (unsigned i = 0; i < dirtyRects.size(); i++)
+			rebuildCells(dirtyRects[i]);
+		dirtyRects.clear();
+		if (changedRects.empty())
+			return false;//Only outside the area
+		version++;
+		return true;
+	}
+
+	void NavigationGrid::markDirty(const AABB& rect)
+	{
+		dirtyRects.push_back(rect);
+	}
+	void NavigationGrid::rebuild()
+	{
+		dirtyRects.push_back(area);
+	}
+
+	bool NavigationGrid::getCellRange(const AABB& rect, int& column0, int& row0, int& column1, int& row1)
+	{
+		const float inverseCellSize = 1.0f / cellSize;
+		const float x0 = floorf((rect.min.x - area.min.x) * inverseCellSize + NAVIGATION_CELL_EPSILON);
+		const float y0 = floorf((rect.min.y - area.min.y) * inverseCellSize + NAVIGATION_CELL_EPSILON);
+		const float x1 = floorf((rect.max.x - area.min.x) * inverseCellSize - NAVIGATION_CELL_EPSILON);
+		const float y1 = floorf((rect.max.y - area.min.y) * inverseCellSize - NAVIGATION_CELL_EPSILON);
+		if (x1 < 0.0f || y1 < 0.0f || x0 >= float(columns) || y0 >= float(rows) || x0 > x1 || y0 > y1)
+			return false;
+		column0 = std::max(0, int(x0));
+		row0 = std::max(0, int(y0));
+		column1 = std::min(columns - 1, int(x1));
+		row1 = std::min(rows - 1, int(y1));
+		return true;
+	}
+
+	void NavigationGrid::rebuildCells(const AABB& rect)
+	{
+		int column0, row0, column1, row1;
+		if (!getCellRange(rect, column0, row0, column1, row1))
+			return;
+		for (int row = row0; row <= row1; row++)
+			std::fill(blocked.begin() + row * columns + column0, blocked.begin() + row * columns + column1 + 1, 0);
+		const AABB cellsRect(area.min + glm::vec2(column0, row0) * cellSize, area.min + glm::vec2(column1 + 1, row1 + 1) * cellSize);
+		changedRects.push_back(cellsRect);
+
+		queryResults.clear();
+		getBroadphase()->queryRect(cellsRect, queryResults, obstacleLayers);
+		const float edge = NAVIGATION_CELL_EPSILON * cellSize;
+		for (unsigned i = 0; i < queryResults.size(); i++)
+		{
+			auto found = obstacleIndices.find(queryResults[i]);
+			if (found == obstacleIndices.end())
+				continue;
+			const OrientedBox& orientedBox = obstacles[found->second].orientedBox;
+			int boxColumn0, boxRow0, boxColumn1, boxRow1;
+			if (!getCellRange(orientedBox.getBounds(), boxColumn0, boxRow0, boxColumn1, boxRow1))
+				continue;
+			boxColumn0 = std::max(boxColumn0, column0);
+			boxRow0 = std::max(boxRow0, row0);
+			boxColumn1 = std::min(boxColumn1, column1);
+			boxRow1 = std::min(boxRow1, row1);
+			const bool axisAligned = fabsf(orientedBox.axis.x) < 1e-6f || fabsf(orientedBox.axis.y) < 1e-6f;
+			for (int row = boxRow0; row <= boxRow1; row++)
+			{
+				for (int column = boxColumn0; column <= boxColumn1; column++)
+				{
+					unsigned char& cell = blocked[row * columns + column];
+					if (cell != 0)
+						continue;
+					if (axisAligned)
+					{//The bounds are the box
+						cell = 1;
+						continue;
+					}
+					OrientedBox cellBox;
+					cellBox.center = area.min + glm::vec2(column + 0.5f, row + 0.5f) * cellSize;
+					cellBox.halfSize = glm::vec2(0.5f * cellSize - edge, 0.5f * cellSize - edge);
+					glm::vec2 normal;
+					float depth;
+					if (cellBox.overlaps(orientedBox, normal, depth))
+						cell = 1;
+				}
+			}
+		}
+	}
+
+	int NavigationGrid::getColumn(float x)
+	{
+		const float column = floorf((x - area.min.x) / cellSize);
+		if (!(column > 0.0f))
+			return 0;
+		return column >= float(columns) ? columns - 1 : int(column);
+	}
+	int NavigationGrid::getRow(float y)
+	{
+		const float row = floorf((y - area.min.y) / cellSize);
+		if (!(row > 0.0f))
+			return 0;
+		return row >= float(rows) ? rows - 1 : int(row);
+	}
+	glm::vec2 NavigationGrid::getCellCenter(unsigned cell)
+	{
+		return area.min + glm::vec2(float(cell % columns) + 0.5f, float(cell / columns) + 0.5f) * cellSize;
+	}
+
+	bool NavigationGrid::findPath(glm::vec2 from, glm::vec2 to, std::vector<glm::vec2>& path)
+	{
+		return findPath(from, to, path, search);
+	}
+
+	bool NavigationGrid::findPath(glm::vec2 from, glm::vec2 to, std::vector<glm::vec2>& path, PathSearch& search)
+	{
+		path.clear();
+		const unsigned start = getCell(from);
+		const unsigned goal = getCell(to);
+		if (blocked[start] != 0 || blocked[goal] != 0)
+			return false;
+		if (start == goal)
+		{
+			path.push_back(getCellCenter(start));
+			return true;
+		}
+
+		search.prepare(blocked.size());
+		const unsigned stamp = search.stamp;
+		const int goalColumn = goal % columns;
+		const int goalRow = goal / columns;
+		//Octile distance, in cells
+		auto heuristic = [goalColumn, goalRow](int column, int row)
+		{
+			const float dx = float(std::abs(column - goalColumn));
+			const float dy = float(std::abs(row - goalRow));
+			return dx > dy ? dx - dy + NAVIGATION_DIAGONAL_COST * dy : dy - dx + NAVIGATION_DIAGONAL_COST * dx;
+		};
+		//Lowest estimate first, ties go to the lower cell so that every thread finds the same path
+		std::greater<std::pair<float, unsigned>> later;
+
+		search.cost[start] = 0.0f;
+		search.parent[start] = start;
+		search.visited[start] = stamp;
+		search.open.push_back(std::make_pair(heuristic(start % columns, start / columns), start));
+		bool found = false;
+		while (!search.open.empty())
+		{
+			std::pop_heap(search.open.begin(), search.open.end(), later);
+			const unsigned cell = search.open.back().second;
+			search.open.pop_back();
+			if (search.closed[cell] == stamp)
+				continue;//Reached again through a shorter path after being queued
+			search.closed[cell] = stamp;
+			if (cell == goal)
+			{
+				found = true;
+				break;
+			}
+
+			const int column = cell % columns;
+			const int row = cell / columns;
+			for (int dy = -1; dy <= 1; dy++)
+			{
+				for (int dx = -1; dx <= 1; dx++)
+				{
+					if ((dx == 0 && dy == 0) || !isWalkable(column + dx, row + dy))
+						continue;
+					const bool diagonal = dx != 0 && dy != 0;
+					if (diagonal && (!isWalkable(column + dx, row) || !isWalkable(column, row + dy)))
+						continue;//Would cut the corner of a blocked cell
+					const unsigned next = (row + dy) * columns + column + dx;
+					if (search.closed[next] == stamp)
+						continue;
+					const float cost = search.cost[cell] + (diagonal ? NAVIGATION_DIAGONAL_COST : 1.0f);
+					if (search.visited[next] == stamp && cost >= search.cost[next])
+						continue;
+					search.visited[next] = stamp;
+					search.cost[next] = cost;
+					search.parent[next] = cell;
+					search.open.push_back(std::make_pair(cost + heuristic(column + dx, row + dy), next));
+					std::push_heap(search.open.begin(), search.open.end(), later);
+				}
+			}
+		}
+		if (!found)
+			return false;
+
+		for (unsigned cell = goal; cell != start; cell = search.parent[cell])
+			search.cells.push_back(cell);
+		search.cells.push_back(start);
+		std::reverse(search.cells.begin(), search.cells.end());
+		//Keep the cells where the direction changes
+		path.push_back(getCellCenter(start));
+		for (unsigned i = 1; i + 1 < search.cells.size(); i++)
+		{
+			const int step0 = int(search.cells[i]) - int(search.cells[i - 1]);
+			const int step1 = int(search.cells[i + 1]) - int(search.cells[i]);
+			if (step0 != step1)
+				path.push_back(getCellCenter(search.cells[i]));
+		}
+		path.push_back(getCellCenter(goal));
+		return true;
+	}
+
+	PathQueue::PathQueue(NavigationGrid& _grid, unsigned _cacheSize) : grid(_grid), nextSearch(0), cacheSize(_cacheSize), gridVersion(_grid.getVersion())
+	{
+	}
+	PathQueue::~PathQueue()
+	{
+		if (batchRunning)
+			waitForCounter(counter);
+	}
+
+	unsigned PathQueue::request(glm::vec2 from, glm::vec2 to)
+	{
+		unsigned ticket;
+		if (freeTickets.empty())
+		{
+			ticket = tickets.size();
+			tickets.push_back(Ticket());
+			tickets.back().generation = 0;
+		}
+		else
+		{
+			ticket = freeTickets.back();
+			freeTickets.pop_back();
+		}
+		Ticket& entry = tickets[ticket];
+		entry.status = PathStatus::Pending;
+		entry.path.clear();
+
+		const uint64_t key = getKey(from, to);
+		checkGridVersion();
+		auto cached = cacheIndices.find(key);
+		if (cached != cacheIndices.end())
+		{
+			CacheEntry& cacheEntry = cache[cached->second];
+			cacheEntry.lastUse = ++useCount;
+			entry.status = cacheEntry.found ? PathStatus::Found : PathStatus::NotFound;
+			entry.path = cacheEntry.path;
+			return ticket;
+		}
+		//Join a search for the same cells. The running jobs don't touch the waiting lists
+		auto search = runningIndices.find(key);
+		if (search != runningIndices.end())
+		{
+			running[search->second].waiting.push_back(std::make_pair(ticket, entry.generation));
+			return ticket;
+		}
+		search = queuedIndices.find(key);
+		if (search == queuedIndices.end())
+		{
+			search = queuedIndices.insert(std::make_pair(key, unsigned(queued.size()))).first;
+			queued.push_back(Search());
+			queued.back().key = key;
+			queued.back().from = from;
+			queued.back().to = to;
+			queued.back().found = false;
+		}
+		queued[search->second].waiting.push_back(std::make_pair(ticket, entry.generation));
+		return ticket;
+	}
+
+	PathStatus PathQueue::getStatus(unsigned ticket)
+	{
+		return tickets[ticket].status;
+	}
+
+	void PathQueue::release(unsigned ticket)
+	{
+		Ticket& entry = tickets[ticket];
+		entry.status = PathStatus::Released;
+		entry.generation++;
+		entry.path.clear();
+		freeTickets.push_back(ticket);
+	}
+
+	void PathQueue::update()
+	{
+		if (batchRunning)
+		{
+			if (!counter.isDone())
+				return;
+			finishBatch();
+		}
+		//No searches are running, the grid can change
+		checkGridVersion();
+		if (grid.update())
+			invalidateCache();
+		gridVersion = grid.getVersion();
+		if (!queued.empty())
+		{
+			startBatch();
+			//Small batches, and batches without workers, are often done already
+			if (counter.isDone())
+				finishBatch();
+		}
+	}
+
+	void PathQueue::startBatch()
+	{
+		running.swap(queued);
+		runningIndices.swap(queuedIndices);
+		queued.clear();
+		queuedIndices.clear();
+		searchCount += running.size();
+		batchRunning = true;
+		batchVersion = grid.getVersion();
+
+		//One job per thread, each takes searches until none are left so that long searches don't hold up a range of short ones
+		const unsigned jobCount = std::min(getWorkerCount() + 1, unsigned(running.size()));
+		if (searchStates.size() < jobCount)
+			searchStates.resize(jobCount);
+		nextSearch = 0;
+		for (unsigned job = 0; job < jobCount; job++)
+		{
+			runJob([this, job]()
+			{
+				PathSearch& state = searchStates[job];
+				const unsigned count = running.size();
+				for (unsigned i = nextSearch++; i < count; i = nextSearch++)
+				{
+					Search& search = running[i];
+					search.found = grid.findPath(search.from, search.to, search.path, state);
+				}
+			}, &counter);
+		}
+	}
+
+	void PathQueue::finishBatch()
+	{
+		batchRunning = false;
+		checkGridVersion();
+		//Results of a grid that has changed since are still delivered, they were right when requested
+		const bool cacheable = batchVersion == gridVersion;
+		for (unsigned i = 0; i < running.size(); i++)
+		{
+			const Search& search = running[i];
+			if (cacheable)
+				addToCache(search);
+			for (unsigned w = 0; w < search.waiting.size(); w++)
+			{
+				Ticket& ticket = tickets[search.waiting[w].first];
+				if (ticket.generation != search.waiting[w].second)
+					continue;//Released while waiting
+				ticket.status = search.found ? PathStatus::Found : PathStatus::NotFound;
+				ticket.path = search.path;
+			}
+		}
+		running.clear();
+		runningIndices.clear();
+	}
+
+	void PathQueue::addToCache(const Search& search)
+	{
+		if (cacheSize == 0)
+			return;
+		unsigned index;
+		auto found = cacheIndices.find(search.key);
+		if (found != cacheIndices.end())
+			index = found->second;
+		else if (cache.size() < cacheSize)
+		{
+			index = cache.size();
+			cache.push_back(CacheEntry());
+			cacheIndices[search.key] = index;
+		}
+		else
+		{//Replace the least recently used
+			index = 0;
+			for (unsigned i = 1; i < cache.size(); i++)
+			{
+				if (cache[i].lastUse < cache[index].lastUse)
+					index = i;
+			}
+			cacheIndices.erase(cache[index].key);
+			cacheIndices[search.key] = index;
+		}
+
+		CacheEntry& entry = cache[index];
+		entry.key = search.key;
+		entry.found = search.found;
+		entry.path = search.path;
+		entry.lastUse = ++useCount;
+		if (!search.path.empty())
+		{//The path's cells, including the ones next to diagonal steps, are within the bounds of its corners
+			entry.bounds = AABB(search.path[0], search.path[0]);
+			for (unsigned i = 1; i < search.path.size(); i++)
+				entry.bounds = entry.bounds.merged(AABB(search.path[i], search.path[i]));
+			entry.bounds = entry.bounds.expanded(0.5f * grid.getCellSize());
+		}
+	}
+
+	void PathQueue::invalidateCache()
+	{
+		const std::vector<AABB>& changedRects = grid.getChangedRects();
+		for (unsigned i = 0; i < cache.size();)
+		{
+			bool keep = cache[i].found;//Changes anywhere can open a path that wasn't found
+			for (unsigned r = 0; keep && r < changedRects.size(); r++)
+				keep = !changedRects[r].overlaps(cache[i].bounds);
+			if (keep)
+			{
+				i++;
+				continue;
+			}
+			cacheIndices.erase(cache[i].key);
+			if (i + 1 < cache.size())
+			{
+				cache[i] = std::move(cache.back());
+				cacheIndices[cache[i].key] = i;
+			}
+			cache.pop_back();
+		}
+	}
+
+	void PathQueue::checkGridVersion()
+	{
+		if (grid.getVersion() == gridVersion)
+			return;
+		clearCache();
+		gridVersion = grid.getVersion();
+	}
+
+	void PathQueue::clearCache()
+	{
+		cache.clear();
+		cacheIndices.clear();
+	}
+}
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <utility>
+#include <atomic>
+#include <cstdint>
+#include <glm/vec2.hpp>
+#include "Broadphase.h"
+#include "JobSystem.h"
+
+#define GINES_NAVIGATION_CELL_SIZE 16.0f	//Default cell size in world units
+#define GINES_PATH_CACHE_SIZE 256			//Results a PathQueue keeps for repeated requests
+
+/*
+Grid pathfinding with the collision boxes as obstacles:
+
+	gines::NavigationGrid grid(gines::AABB(glm::vec2(0, 0), glm::vec2(4096, 4096)), 16.0f, wallLayers);
+	gines::PathQueue paths(grid);
+
+	unsigned ticket = paths.request(agentPosition, target);
+	...
+	if (paths.getStatus(ticket) == gines::PathStatus::Found)
+		follow(paths.getPath(ticket));
+	paths.release(ticket);
+
+	paths.update();//Once per frame, after beginMainLoop()
+
+NavigationGrid blocks the cells covered by static boxes: boxes on the obstacle layers whose game object has no PhysicsComponent.
+update() finds the obstacles that were added, moved or removed and rebuilds only the cells under them.
+Searches are A* over the 8 neighbours of a cell, diagonal steps don't cut past blocked cells.
+
+PathQueue runs the searches as jobs in batches. Requests made during a frame are started together by the next update(),
+and a later update() collects the results once the batch is done, so the main loop never waits for a search.
+The grid is only updated between batches. Requests between the same two cells share one search, and results are cached
+until cells under them are rebuilt. Paths that failed are forgotten whenever the grid changes.
+Other code, or another queue, may update the same grid while no batch is running. The queue notices from the grid's
+version and drops its whole cache, since it doesn't know which cells changed.
+*/
+namespace gines
+{
+	class CollisionBox;
+
+	//Search state, one per thread that searches
+	class PathSearch
+	{
+	public:
+		PathSearch(){}
+	private:
+		friend class NavigationGrid;
+		void prepare(unsigned cellCount);
+		std::vector<float> cost;
+		std::vector<unsigned> parent;
+		std::vector<unsigned> visited;//Stamp of the search that reached the cell
+		std::vector<unsigned> closed;
+		std::vector<std::pair<float, unsigned>> open;//Heap of estimated total cost and cell
+		std::vector<unsigned> cells;
+		unsigned stamp = 0;
+	};
+
+	class NavigationGrid
+	{
+	public:
+		NavigationGrid(const AABB& area, float cellSize = GINES_NAVIGATION_CELL_SIZE, unsigned obstacleLayers = GINES_ALL_LAYERS);
+		~NavigationGrid();
+
+		/*Rebuilds the cells under obstacles that were added, moved or removed since the last call, and the rects marked dirty.
+		Goes through every collision box like updateBroadphase(). Returns true if any cells were rebuilt*/
+		bool update();
+		void markDirty(const AABB& rect);//Rebuilt on the next update()
+		void rebuild();//Every cell, on the next update()
+
+		/*Path from the center of from's cell to the center of to's cell, keeping only the points where it turns.
+		Points outside the area use the closest cell. Returns false if there is no path*/
+		bool findPath(glm::vec2 from, glm::vec2 to, std::vector<glm::vec2>& path);
+		//Several threads can search at once with their own search states, as long as update() isn't running
+		bool findPath(glm::vec2 from, glm::vec2 to, std::vector<glm::vec2>& path, PathSearch& search);
+
+		int getColumn(float x);//Clamped to the grid
+		int getRow(float y);
+		unsigned getCell(glm::vec2 point){ return getRow(point.y) * columns + getColumn(point.x); }
+		glm::vec2 getCellCenter(unsigned cell);
+		bool isBlocked(unsigned cell){ return blocked[cell] != 0; }
+		bool isBlocked(glm::vec2 point){ return blocked[getCell(point)] != 0; }
+		int getColumns(){ return columns; }
+		int getRows(){ return rows; }
+		float getCellSize(){ return cellSize; }
+		const AABB& getArea(){ return area; }
+		unsigned getObstacleLayers(){ return obstacleLayers; }
+		unsigned getVersion(){ return version; }//Changes whenever cells are rebuilt
+		const std::vector<AABB>& getChangedRects(){ return changedRects; }//World rects rebuilt by the last update()
+
+	private:
+		NavigationGrid(const NavigationGrid&);
+		void operator=(const NavigationGrid&);
+
+		struct Obstacle
+		{
+			CollisionBox* box;
+			OrientedBox orientedBox;//When the cells were last built
+			unsigned scan;//Last update() that found the box
+		};
+		bool isObstacle(CollisionBox* box);
+		bool getCellRange(const AABB& rect, int& column0, int& row0, int& column1, int& row1);//Cells whose inside rect reaches
+		void rebuildCells(const AABB& rect);
+		bool isWalkable(int column, int row){ return column >= 0 && row >= 0 && column < columns && row < rows && blocked[row * columns + column] == 0; }
+
+		AABB area;
+		float cellSize;
+		int columns;
+		int rows;
+		unsigned obstacleLayers;
+		std::vector<unsigned char> blocked;
+
+		std::vector<Obstacle> obstacles;
+		std::unordered_map<CollisionBox*, unsigned> obstacleIndices;//Index in obstacles
+		unsigned scan = 0;
+		std::vector<AABB> dirtyRects;
+		std::vector<AABB> changedRects;
+		std::vector<CollisionBox*> queryResults;
+		unsigned version = 0;
+		PathSearch search;//For findPath without a search state
+	};
+
+	enum class PathStatus
+	{
+		Pending,
+		Found,
+		NotFound,
+		Released//Not a ticket in use
+	};
+
+	class PathQueue
+	{
+	public:
+		PathQueue(NavigationGrid& grid, unsigned cacheSize = GINES_PATH_CACHE_SIZE);
+		~PathQueue();//Waits for the running searches
+
+		/*Returns a ticket for the path from from to to, see NavigationGrid::findPath. Cached results are ready right away,
+		others once an update() has collected them. Tickets must be released*/
+		unsigned request(glm::vec2 from, glm::vec2 to);
+		PathStatus getStatus(unsigned ticket);
+		const std::vector<glm::vec2>& getPath(unsigned ticket){ return tickets[ticket].path; }//Empty unless found, valid until the next request()
+		void release(unsigned ticket);
+
+		//Collects the finished batch, then updates the grid and starts the next batch if none is running
+		void update();
+		void clearCache();
+
+		unsigned getQueuedCount(){ return queued.size(); }//Searches waiting for the next batch
+		unsigned getRunningCount(){ return running.size(); }
+		unsigned getSearchCount(){ return searchCount; }//Searches run, not counting shared and cached requests
+
+	private:
+		PathQueue(const PathQueue&);
+		void operator=(const PathQueue&);
+
+		struct Ticket
+		{
+			PathStatus status;
+			unsigned generation;//Bumped on release, so searches don't deliver to a reused ticket
+			std::vector<glm::vec2> path;
+		};
+		struct Search
+		{
+			uint64_t key;
+			glm::vec2 from;
+			glm::vec2 to;
+			bool found;
+			std::vector<glm::vec2> path;
+			std::vector<std::pair<unsigned, unsigned>> waiting;//Ticket and its generation
+		};
+		struct CacheEntry
+		{
+			uint64_t key;
+			bool found;
+			std::vector<glm::vec2> path;
+			AABB bounds;//Of the path
+			unsigned lastUse;
+		};
+		uint64_t getKey(glm::vec2 from, glm::vec2 to){ return (uint64_t(grid.getCell(from)) << 32) | grid.getCell(to); }
+		void finishBatch();
+		void startBatch();
+		void addToCache(const Search& search);
+		void invalidateCache();
+		void checkGridVersion();//Drops the cache if the grid was changed outside update()
+
+		NavigationGrid& grid;
+		std::vector<Ticket> tickets;
+		std::vector<unsigned> freeTickets;
+
+		std::vector<Search> queued;//Requested since the running batch started
+		std::unordered_map<uint64_t, unsigned> queuedIndices;
+		std::vector<Search> running;
+		std::unordered_map<uint64_t, unsigned> runningIndices;
+		std::vector<PathSearch> searchStates;//One per job
+		std::atomic<unsigned> nextSearch;//Jobs take the running searches one at a time
+		JobCounter counter;
+		bool batchRunning = false;
+		unsigned batchVersion = 0;//Grid version the running searches see
+		unsigned searchCount = 0;
+
+		std::vector<CacheEntry> cache;
+		std::unordered_map<uint64_t, unsigned> cacheIndices;
+		unsigned cacheSize;
+		unsigned useCount = 0;
+		unsigned gridVersion;//Grid version the cache is valid for
+	};
+}
@@ -1,16 +1,73 @@
 #include "PhysicsComponent.h"
+#include "PhysicsWorld.h"
 
 namespace gines
 {
 	PhysicsComponent::PhysicsComponent() {
-
+		bodyId = getPhysicsWorld().add(this);
+	}
+	PhysicsComponent::PhysicsComponent(const PhysicsComponent& original) : MonoComponent(original) {
+		bodyId = getPhysicsWorld().add(this);
+		getPhysicsWorld().copy(original.bodyId, bodyId);
 	}
-
 	PhysicsComponent::~PhysicsComponent() {
+		getPhysicsWorld().remove(bodyId);
+	}
+	void PhysicsComponent::onPrefabPrototype() {
+		getPhysicsWorld().sleep(bodyId);
+	}
 
+	void PhysicsComponent::setVelocity(glm::vec2 velocity) {
+		getPhysicsWorld().setVelocity(bodyId, velocity);
+	}
+	glm::vec2 PhysicsComponent::getVelocity() {
+		return getPhysicsWorld().getVelocity(bodyId);
+	}
+	void PhysicsComponent::setAngularVelocity(float radiansPerSecond) {
+		getPhysicsWorld().setAngularVelocity(bodyId, radiansPerSecond);
+	}
+	float PhysicsComponent::getAngularVelocity() {
+		return getPhysicsWorld().getAngularVelocity(bodyId);
+	}
+	void PhysicsComponent::addForce(glm::vec2 force) {
+		getPhysicsWorld().addForce(bodyId, force);
+	}
+	void PhysicsComponent::addImpulse(glm::vec2 impulse) {
+		getPhysicsWorld().addImpulse(bodyId, impulse);
 	}
 
-	void PhysicsComponent::update() {
+	void PhysicsComponent::setMass(float mass) {
+		getPhysicsWorld().setMass(bodyId, mass);
+	}
+	float PhysicsComponent::getMass() {
+		return getPhysicsWorld().getMass(bodyId);
+	}
+	void PhysicsComponent::setRestitution(float restitution) {
+		getPhysicsWorld().setRestitution(bodyId, restitution);
+	}
+	float PhysicsComponent::getRestitution() {
+		return getPhysicsWorld().getRestitution(bodyId);
+	}
+	void PhysicsComponent::setFriction(float friction) {
+		getPhysicsWorld().setFriction(bodyId, friction);
+	}
+	float PhysicsComponent::getFriction() {
+		return getPhysicsWorld().getFriction(bodyId);
+	}
+	void PhysicsComponent::setGravityScale(float scale) {
+		getPhysicsWorld().setGravityScale(bodyId, scale);
+	}
+	float PhysicsComponent::getGravityScale() {
+		return getPhysicsWorld().getGravityScale(bodyId);
+	}
 
+	void PhysicsComponent::setSleepingAllowed(bool allowed) {
+		getPhysicsWorld().setSleepingAllowed(bodyId, allowed);
+	}
+	bool PhysicsComponent::isAwake() {
+		return getPhysicsWorld().isAwake(bodyId);
+	}
+	void PhysicsComponent::wakeUp() {
+		getPhysicsWorld().wakeUp(bodyId);
 	}
-}
\ No newline at end of file
+}
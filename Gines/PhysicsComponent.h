@@ -1,17 +1,46 @@
 #pragma once
 
+#include <glm/vec2.hpp>
 #include "Component.h"
 
 namespace gines
 {
-	//Coming soon
+	/*Rigid body, simulated by the PhysicsWorld (see PhysicsWorld.h). The body collides through the collision boxes
+	on its game object and moves the game object's transform. The body data itself lives in the world*/
 	class PhysicsComponent : public MonoComponent
 	{
 	public:
 		PhysicsComponent();
+		PhysicsComponent(const PhysicsComponent& original);
 		~PhysicsComponent();
 
-		void update();
+		bool isThreadSafe(){ return true; }//No update
+		void onPrefabPrototype();//Puts the body to sleep, copies made from the prototype start awake
+
+		void setVelocity(glm::vec2 velocity);
+		glm::vec2 getVelocity();
+		void setAngularVelocity(float radiansPerSecond);
+		float getAngularVelocity();
+		void addForce(glm::vec2 force);//Applied in every fixed step of the next physics update, add it again each frame
+		void addImpulse(glm::vec2 impulse);//Changes the velocity right away
+
+		//Mass 0 makes the body kinematic: it moves with its velocity but nothing pushes it
+		void setMass(float mass);
+		float getMass();
+		void setRestitution(float restitution);//0 doesn't bounce, 1 bounces back at full speed
+		float getRestitution();
+		void setFriction(float friction);
+		float getFriction();
+		void setGravityScale(float scale);
+		float getGravityScale();
+
+		//Bodies that stay still sleep until something runs into them or they are changed
+		void setSleepingAllowed(bool allowed);
+		bool isAwake();
+		void wakeUp();
+
+		unsigned getBodyId(){ return bodyId; }
 	private:
+		unsigned bodyId;
 	};
 }
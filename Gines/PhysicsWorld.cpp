@@ -0,0 +1,734 @@
+#include "PhysicsWorld.h"
+#include "PhysicsComponent.h"
+#include "CollisionBox.h"
+#include "GameObject.h"
+#include "Gines.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <functional>
+#include <climits>
+#include <cmath>
+
+#define PHYSICS_BAUMGARTE 0.2f				//Fraction of the penetration removed per substep
+#define PHYSICS_SLOP 0.5f					//Penetration that is allowed to remain, keeps resting contacts stable
+#define PHYSICS_RESTITUTION_THRESHOLD 30.0f	//Closing speeds below this don't bounce
+#define PHYSICS_SLEEP_LINEAR 4.0f			//Speed under which a body counts as still
+#define PHYSICS_SLEEP_ANGULAR 0.05f			//Radians per second
+#define PHYSICS_COLORS 64					//Colors of a large island, one bit each. Contacts beyond them are solved serially
+#define PHYSICS_COLOR_GRAIN_SIZE 64			//Contacts per job when solving a color
+
+namespace gines
+{
+	int physicsSubsteps = 1;
+
+	PhysicsWorld::PhysicsWorld() : gravity(0.0f, GINES_PHYSICS_GRAVITY)
+	{
+	}
+	PhysicsWorld::~PhysicsWorld()
+	{
+	}
+
+	unsigned PhysicsWorld::add(PhysicsComponent* owner)
+	{
+		unsigned id;
+		if (freeIds.empty())
+		{
+			id = dense.size();
+			dense.push_back(0);
+		}
+		else
+		{
+			id = freeIds.back();
+			freeIds.pop_back();
+		}
+		dense[id] = owners.size();
+		ids.push_back(id);
+		owners.push_back(owner);
+		velocityX.push_back(0.0f);
+		velocityY.push_back(0.0f);
+		angularVelocity.push_back(0.0f);
+		forceX.push_back(0.0f);
+		forceY.push_back(0.0f);
+		inverseMass.push_back(1.0f);
+		restitution.push_back(0.0f);
+		friction.push_back(0.5f);
+		gravityScale.push_back(1.0f);
+		sleepTime.push_back(0.0f);
+		awake.push_back(1);
+		sleepingAllowed.push_back(1);
+		bodyTypesDirty = true;
+		return id;
+	}
+	void PhysicsWorld::remove(unsigned id)
+	{
+		if (!contains(id))
+			return;
+		bodyTypesDirty = true;
+		unsigned index = dense[id];
+		unsigned last = owners.size() - 1;
+		if (index != last)
+		{
+			velocityX[index] = velocityX[last];
+			velocityY[index] = velocityY[last];
+			angularVelocity[index] = angularVelocity[last];
+			forceX[index] = forceX[last];
+			forceY[index] = forceY[last];
+			inverseMass[index] = inverseMass[last];
+			restitution[index] = restitution[last];
+			friction[index] = friction[last];
+			gravityScale[index] = gravityScale[last];
+			sleepTime[index] = sleepTime[last];
+			awake[index] = awake[last];
+			sleepingAllowed[index] = sleepingAllowed[last];
+			owners[index] = owners[last];
+			ids[index] = ids[last];
+			dense[ids[index]] = index;
+		}
+		velocityX.pop_back();
+		velocityY.pop_back();
+		angularVelocity.pop_back();
+		forceX.pop_back();
+		forceY.pop_back();
+		inverseMass.pop_back();
+		restitution.pop_back();
+		friction.pop_back();
+		gravityScale.pop_back();
+		sleepTime.pop_back();
+		awake.pop_back();
+		sleepingAllowed.pop_back();
+		owners.pop_back();
+		ids.pop_back();
+		dense[id] = UINT_MAX;
+		freeIds.push_back(id);
+	}
+	bool PhysicsWorld::contains(unsigned id)
+	{
+		return id < dense.size() && dense[id] != UINT_MAX;
+	}
+	void PhysicsWorld::copy(unsigned from, unsigned to)
+	{
+		unsigned a = dense[from];
+		unsigned b = dense[to];
+		velocityX[b] = velocityX[a];
+		velocityY[b] = velocityY[a];
+		angularVelocity[b] = angularVelocity[a];
+		forceX[b] = forceX[a];
+		forceY[b] = forceY[a];
+		inverseMass[b] = inverseMass[a];
+		restitution[b] = restitution[a];
+		friction[b] = friction[a];
+		gravityScale[b] = gravityScale[a];
+		sleepTime[b] = 0.0f;
+		awake[b] = 1;
+		sleepingAllowed[b] = sleepingAllowed[a];
+	}
+
+	void PhysicsWorld::wakeIndex(unsigned i)
+	{
+		awake[i] = 1;
+		sleepTime[i] = 0.0f;
+	}
+	void PhysicsWorld::wakeUp(unsigned id)
+	{
+		wakeIndex(dense[id]);
+	}
+	void PhysicsWorld::sleep(unsigned id)
+	{
+		awake[dense[id]] = 0;
+	}
+	void PhysicsWorld::setSleepingAllowed(unsigned id, bool allowed)
+	{
+		sleepingAllowed[dense[id]] = allowed ? 1 : 0;
+		if (!allowed)
+			wakeUp(id);
+	}
+	void PhysicsWorld::setVelocity(unsigned id, glm::vec2 velocity)
+	{
+		unsigned i = dense[id];
+		velocityX[i] = velocity.x;
+		velocityY[i] = velocity.y;
+		wakeIndex(i);
+	}
+	void PhysicsWorld::setAngularVelocity(unsigned id, float velocity)
+	{
+		unsigned i = dense[id];
+		angularVelocity[i] = velocity;
+		wakeIndex(i);
+	}
+	void PhysicsWorld::addForce(unsigned id, glm::vec2 force)
+	{
+		unsigned i = dense[id];
+		forceX[i] += force.x;
+		forceY[i] += force.y;
+		wakeIndex(i);
+	}
+	void PhysicsWorld::addImpulse(unsigned id, glm::vec2 impulse)
+	{
+		unsigned i = dense[id];
+		velocityX[i] += impulse.x * inverseMass[i];
+		velocityY[i] += impulse.y * inverseMass[i];
+		wakeIndex(i);
+	}
+	void PhysicsWorld::setMass(unsigned id, float mass)
+	{
+		unsigned i = dense[id];
+		inverseMass[i] = mass > 0.0f ? 1.0f / mass : 0.0f;
+		wakeIndex(i);
+	}
+
+	void PhysicsWorld::update(float seconds)
+	{
+		accumulator += seconds;
+		int steps = 0;
+		while (accumulator >= timestep && steps < GINES_PHYSICS_MAX_STEPS)
+		{
+			step(timestep);
+			accumulator -= timestep;
+			steps++;
+		}
+		if (steps == GINES_PHYSICS_MAX_STEPS && accumulator >= timestep)
+			accumulator = 0.0f;//Too far behind, drop the rest instead of spiraling
+		//Forces are added once per frame, they act in every step of the frame so the result doesn't depend on the frame rate
+		clearForces();
+	}
+	void PhysicsWorld::clearForces()
+	{
+		std::fill(forceX.begin(), forceX.end(), 0.0f);
+		std::fill(forceY.begin(), forceY.end(), 0.0f);
+	}
+	void PhysicsWorld::step(float deltaTime)
+	{
+		const int substeps = physicsSubsteps > 0 ? physicsSubsteps : 1;
+		for (int i = 0; i < substeps; i++)
+			substep(deltaTime / substeps);
+	}
+	void PhysicsWorld::substep(float deltaTime)
+	{
+		//Forces and gravity
+		const unsigned count = owners.size();
+		for (unsigned i = 0; i < count; i++)
+		{
+			if (!awake[i] || inverseMass[i] == 0.0f)
+				continue;
+			velocityX[i] += (gravity.x * gravityScale[i] + forceX[i] * inverseMass[i]) * deltaTime;
+			velocityY[i] += (gravity.y * gravityScale[i] + forceY[i] * inverseMass[i]) * deltaTime;
+		}
+
+		buildConstraints(deltaTime);
+		buildIslands();
+		solveIslands();
+		sweepBullets(deltaTime);
+		integratePositions(deltaTime);
+		updateSleep(deltaTime);
+	}
+
+	unsigned PhysicsWorld::findBody(CollisionBox* box)
+	{
+		PhysicsComponent* body = findComponent(box->getGameObject());
+		if (body == nullptr || !contains(body->getBodyId()))
+			return UINT_MAX;
+		return dense[body->getBodyId()];
+	}
+	PhysicsComponent* PhysicsWorld::findComponent(GameObject* object)
+	{
+		if (object == nullptr)
+			return nullptr;
+		PhysicsComponent* body = object->getComponent<PhysicsComponent>();
+		if (body != nullptr)
+			return body;
+		if (bodyTypesDirty)
+		{//Type ids are set once the component is attached, so they are counted here rather than in add()
+			const unsigned typeId = ComponentType<PhysicsComponent>::id();
+			derivedBodies = false;
+			for (unsigned i = 0; i < owners.size() && !derivedBodies; i++)
+				derivedBodies = owners[i]->getTypeId() != typeId;
+			bodyTypesDirty = false;
+		}
+		return derivedBodies ? object->getComponentDerived<PhysicsComponent>() : nullptr;
+	}
+	void PhysicsWorld::buildConstraints(float deltaTime)
+	{
+		updateBroadphase();
+		pairs.clear();
+		getBroadphase()->queryPairs(pairs);
+
+		//Only pairs with a dynamic body in them, before any narrowphase work
+		bodyPairs.clear();
+		for (unsigned p = 0; p < pairs.size(); p++)
+		{
+			const unsigned a = findBody(pairs[p].a);
+			const unsigned b = findBody(pairs[p].b);
+			if (a == b)
+				continue;//Static pair, or two boxes of the same body
+			const bool dynamicA = a != UINT_MAX && inverseMass[a] > 0.0f;
+			const bool dynamicB = b != UINT_MAX && inverseMass[b] > 0.0f;
+			if (!dynamicA && !dynamicB)
+				continue;
+			bodyPairs.push_back(pairs[p]);
+		}
+		contacts.clear();
+		findContacts(bodyPairs, contacts);
+
+		std::less<CollisionBox*> less;
+		previousConstraints.swap(constraints);
+		constraints.resize(contacts.size());
+		for (unsigned c = 0; c < contacts.size(); c++)
+		{
+			ContactConstraint& constraint = constraints[c];
+			constraint.boxA = contacts[c].a;
+			constraint.boxB = contacts[c].b;
+			constraint.normal = contacts[c].normal;
+			if (less(constraint.boxB, constraint.boxA))
+			{//Same order as the previous step's constraints
+				std::swap(constraint.boxA, constraint.boxB);
+				constraint.normal = -constraint.normal;
+			}
+			constraint.depth = contacts[c].depth;
+			constraint.bodyA = findBody(constraint.boxA);
+			constraint.bodyB = findBody(constraint.boxB);
+
+			//A moving body wakes a sleeping one it runs into
+			const unsigned a = constraint.bodyA;
+			const unsigned b = constraint.bodyB;
+			if (a != UINT_MAX && b != UINT_MAX && awake[a] != awake[b])
+			{
+				const unsigned sleeper = awake[a] ? b : a;
+				const unsigned mover = awake[a] ? a : b;
+				if (sleepTime[mover] == 0.0f)
+					wakeIndex(sleeper);
+			}
+		}
+
+		//Bodies don't wake up past this point, so a body is either solved or static in all of its contacts
+		unsigned kept = 0;
+		for (unsigned c = 0; c < constraints.size(); c++)
+		{
+			ContactConstraint constraint = constraints[c];
+			const unsigned a = constraint.bodyA;
+			const unsigned b = constraint.bodyB;
+			if ((a == UINT_MAX || !awake[a]) && (b == UINT_MAX || !awake[b]))
+				continue;//Nothing awake to push
+
+			//Sleeping bodies act static until they wake
+			constraint.inverseMassA = a != UINT_MAX && awake[a] ? inverseMass[a] : 0.0f;
+			constraint.inverseMassB = b != UINT_MAX && awake[b] ? inverseMass[b] : 0.0f;
+			const float massSum = constraint.inverseMassA + constraint.inverseMassB;
+			if (massSum == 0.0f)
+				continue;
+			constraint.normalMass = 1.0f / massSum;
+			constraint.tangentMass = constraint.normalMass;
+
+			//Static boxes take the material of the body
+			const float frictionA = a != UINT_MAX ? friction[a] : friction[b];
+			const float frictionB = b != UINT_MAX ? friction[b] : friction[a];
+			constraint.friction = std::sqrt(frictionA * frictionB);
+			const float restitutionA = a != UINT_MAX ? restitution[a] : 0.0f;
+			const float restitutionB = b != UINT_MAX ? restitution[b] : 0.0f;
+			const float bounce = restitutionA > restitutionB ? restitutionA : restitutionB;
+
+			//Separation target from penetration and bounce
+			float relativeX = 0.0f, relativeY = 0.0f;
+			if (b != UINT_MAX)
+			{
+				relativeX += velocityX[b];
+				relativeY += velocityY[b];
+			}
+			if (a != UINT_MAX)
+			{
+				relativeX -= velocityX[a];
+				relativeY -= velocityY[a];
+			}
+			const float closingSpeed = relativeX * constraint.normal.x + relativeY * constraint.normal.y;
+			float bias = PHYSICS_BAUMGARTE / deltaTime * (constraint.depth - PHYSICS_SLOP);
+			if (bias < 0.0f)
+				bias = 0.0f;
+			if (closingSpeed < -PHYSICS_RESTITUTION_THRESHOLD && -bounce * closingSpeed > bias)
+				bias = -bounce * closingSpeed;
+			constraint.bias = bias;
+			constraint.normalImpulse = 0.0f;
+			constraint.tangentImpulse = 0.0f;
+			constraints[kept++] = constraint;
+		}
+		constraints.resize(kept);
+		std::sort(constraints.begin(), constraints.end(), constraintLess);
+
+		//Carry the impulses of contacts that persist
+		unsigned previous = 0;
+		for (unsigned c = 0; c < constraints.size() && previous < previousConstraints.size(); c++)
+		{
+			while (previous < previousConstraints.size() && constraintLess(previousConstraints[previous], constraints[c]))
+				previous++;
+			if (previous < previousConstraints.size() && !constraintLess(constraints[c], previousConstraints[previous]))
+			{
+				constraints[c].normalImpulse = previousConstraints[previous].normalImpulse;
+				constraints[c].tangentImpulse = previousConstraints[previous].tangentImpulse;
+			}
+		}
+	}
+	bool PhysicsWorld::constraintLess(const ContactConstraint& left, const ContactConstraint& right)
+	{
+		std::less<CollisionBox*> less;
+		if (left.boxA != right.boxA)
+			return less(left.boxA, right.boxA);
+		return less(left.boxB, right.boxB);
+	}
+
+	unsigned PhysicsWorld::findRoot(unsigned body)
+	{
+		while (islandParents[body] != body)
+		{
+			islandParents[body] = islandParents[islandParents[body]];//Path halving
+			body = islandParents[body];
+		}
+		return body;
+	}
+	void PhysicsWorld::buildIslands()
+	{
+		//Join the bodies that are solved on both sides of a contact, the lowest body index is the root
+		const unsigned count = owners.size();
+		islandParents.resize(count);
+		for (unsigned i = 0; i < count; i++)
+			islandParents[i] = i;
+		for (unsigned c = 0; c < constraints.size(); c++)
+		{
+			const ContactConstraint& constraint = constraints[c];
+			if (constraint.inverseMassA == 0.0f || constraint.inverseMassB == 0.0f)
+				continue;
+			const unsigned rootA = findRoot(constraint.bodyA);
+			const unsigned rootB = findRoot(constraint.bodyB);
+			if (rootA < rootB)
+				islandParents[rootB] = rootA;
+			else if (rootB < rootA)
+				islandParents[rootA] = rootB;
+		}
+
+		//Islands are numbered in the order of their root, every awake dynamic body is in one
+		bodyIslands.assign(count, UINT_MAX);
+		unsigned islandCount = 0;
+		for (unsigned i = 0; i < count; i++)
+		{
+			if (!awake[i] || inverseMass[i] == 0.0f)
+				continue;
+			const unsigned root = findRoot(i);
+			if (root == i)
+				bodyIslands[i] = islandCount++;
+			else
+				bodyIslands[i] = bodyIslands[root];
+		}
+
+		//Bucket the bodies and contacts by island, keeping their order
+		islandBodyStart.assign(islandCount + 1, 0);
+		for (unsigned i = 0; i < count; i++)
+		{
+			if (bodyIslands[i] != UINT_MAX)
+				islandBodyStart[bodyIslands[i] + 1]++;
+		}
+		for (unsigned i = 0; i < islandCount; i++)
+			islandBodyStart[i + 1] += islandBodyStart[i];
+		islandBodies.resize(islandBodyStart[islandCount]);
+		islandCursor.assign(islandBodyStart.begin(), islandBodyStart.end() - 1);
+		for (unsigned i = 0; i < count; i++)
+		{
+			if (bodyIslands[i] != UINT_MAX)
+				islandBodies[islandCursor[bodyIslands[i]]++] = i;
+		}
+
+		islandConstraintStart.assign(islandCount + 1, 0);
+		for (unsigned c = 0; c < constraints.size(); c++)
+		{
+			const ContactConstraint& constraint = constraints[c];
+			const unsigned island = bodyIslands[constraint.inverseMassA > 0.0f ? constraint.bodyA : constraint.bodyB];
+			islandConstraintStart[island + 1]++;
+		}
+		for (unsigned i = 0; i < islandCount; i++)
+			islandConstraintStart[i + 1] += islandConstraintStart[i];
+		islandConstraints.resize(constraints.size());
+		islandCursor.assign(islandConstraintStart.begin(), islandConstraintStart.end() - 1);
+		for (unsigned c = 0; c < constraints.size(); c++)
+		{
+			const ContactConstraint& constraint = constraints[c];
+			const unsigned island = bodyIslands[constraint.inverseMassA > 0.0f ? constraint.bodyA : constraint.bodyB];
+			islandConstraints[islandCursor[island]++] = c;
+		}
+
+		smallIslands.clear();
+		largeIslands.clear();
+		for (unsigned i = 0; i < islandCount; i++)
+		{
+			const unsigned size = islandConstraintStart[i + 1] - islandConstraintStart[i];
+			if (size >= GINES_PHYSICS_COLORING_THRESHOLD)
+				largeIslands.push_back(i);
+			else if (size > 0)
+				smallIslands.push_back(i);
+		}
+	}
+	void PhysicsWorld::solveIslands()
+	{
+		//Islands vary a lot in size, so every worker gets a few ranges
+		if (!smallIslands.empty())
+		{
+			const unsigned ranges = (getWorkerCount() + 1) * 4;
+			const unsigned grainSize = smallIslands.size() / ranges > 0 ? smallIslands.size() / ranges : 1;
+			parallelFor(0, smallIslands.size(), grainSize, [this](unsigned begin, unsigned end) {
+				for (unsigned i = begin; i < end; i++)
+					solveIsland(smallIslands[i]);
+			});
+		}
+		for (unsigned i = 0; i < largeIslands.size(); i++)
+			solveColoredIsland(largeIslands[i]);
+	}
+	void PhysicsWorld::solveIsland(unsigned island)
+	{
+		const unsigned begin = islandConstraintStart[island];
+		const unsigned end = islandConstraintStart[island + 1];
+		for (unsigned c = begin; c < end; c++)
+			warmStart(constraints[islandConstraints[c]]);
+		for (int iteration = 0; iteration < GINES_PHYSICS_ITERATIONS; iteration++)
+		{
+			for (unsigned c = begin; c < end; c++)
+				solve(constraints[islandConstraints[c]]);
+		}
+	}
+	void PhysicsWorld::solveColoredIsland(unsigned island)
+	{
+		const unsigned begin = islandConstraintStart[island];
+		const unsigned end = islandConstraintStart[island + 1];
+
+		//Greedy coloring in contact order, each contact takes the lowest color that neither of its solved bodies has yet
+		bodyColors.resize(owners.size());
+		for (unsigned i = islandBodyStart[island]; i < islandBodyStart[island + 1]; i++)
+			bodyColors[islandBodies[i]] = 0;
+		constraintColors.resize(end - begin);
+		colorStart.assign(PHYSICS_COLORS + 1, 0);
+		overflowConstraints.clear();
+		for (unsigned c = begin; c < end; c++)
+		{
+			const ContactConstraint& constraint = constraints[islandConstraints[c]];
+			uint64_t used = 0;
+			if (constraint.inverseMassA > 0.0f)
+				used |= bodyColors[constraint.bodyA];
+			if (constraint.inverseMassB > 0.0f)
+				used |= bodyColors[constraint.bodyB];
+			unsigned color = 0;
+			while (color < PHYSICS_COLORS && (used & (uint64_t(1) << color)) != 0)
+				color++;
+			constraintColors[c - begin] = color;
+			if (color == PHYSICS_COLORS)
+			{
+				overflowConstraints.push_back(islandConstraints[c]);
+				continue;
+			}
+			if (constraint.inverseMassA > 0.0f)
+				bodyColors[constraint.bodyA] |= uint64_t(1) << color;
+			if (constraint.inverseMassB > 0.0f)
+				bodyColors[constraint.bodyB] |= uint64_t(1) << color;
+			colorStart[color + 1]++;
+		}
+		for (unsigned color = 0; color < PHYSICS_COLORS; color++)
+			colorStart[color + 1] += colorStart[color];
+		colorConstraints.resize(colorStart[PHYSICS_COLORS]);
+		islandCursor.assign(colorStart.begin(), colorStart.end() - 1);
+		for (unsigned c = begin; c < end; c++)
+		{
+			const unsigned color = constraintColors[c - begin];
+			if (color < PHYSICS_COLORS)
+				colorConstraints[islandCursor[color]++] = islandConstraints[c];
+		}
+
+		for (unsigned c = begin; c < end; c++)
+			warmStart(constraints[islandConstraints[c]]);
+		for (int iteration = 0; iteration < GINES_PHYSICS_ITERATIONS; iteration++)
+		{
+			//Contacts of one color touch different bodies, so splitting them between threads doesn't change the result
+			for (unsigned color = 0; color < PHYSICS_COLORS && colorStart[color] < colorStart[color + 1]; color++)
+			{
+				parallelFor(colorStart[color], colorStart[color + 1], PHYSICS_COLOR_GRAIN_SIZE, [this](unsigned begin, unsigned end) {
+					for (unsigned c = begin; c < end; c++)
+						solve(constraints[colorConstraints[c]]);
+				});
+			}
+			for (unsigned c = 0; c < overflowConstraints.size(); c++)
+				solve(constraints[overflowConstraints[c]]);
+		}
+	}
+	void PhysicsWorld::warmStart(ContactConstraint& constraint)
+	{
+		//Tangent is the normal turned 90 degrees counter clockwise
+		const float impulseX = constraint.normal.x * constraint.normalImpulse - constraint.normal.y * constraint.tangentImpulse;
+		const float impulseY = constraint.normal.y * constraint.normalImpulse + constraint.normal.x * constraint.tangentImpulse;
+		//Only solved bodies are written, static and sleeping ones may be read by other islands at the same time
+		if (constraint.inverseMassA > 0.0f)
+		{
+			velocityX[constraint.bodyA] -= impulseX * constraint.inverseMassA;
+			velocityY[constraint.bodyA] -= impulseY * constraint.inverseMassA;
+		}
+		if (constraint.inverseMassB > 0.0f)
+		{
+			velocityX[constraint.bodyB] += impulseX * constraint.inverseMassB;
+			velocityY[constraint.bodyB] += impulseY * constraint.inverseMassB;
+		}
+	}
+	void PhysicsWorld::solve(ContactConstraint& constraint)
+	{
+		const unsigned a = constraint.bodyA;
+		const unsigned b = constraint.bodyB;
+		const float normalX = constraint.normal.x;
+		const float normalY = constraint.normal.y;
+		float velocityAX = a != UINT_MAX ? velocityX[a] : 0.0f;
+		float velocityAY = a != UINT_MAX ? velocityY[a] : 0.0f;
+		float velocityBX = b != UINT_MAX ? velocityX[b] : 0.0f;
+		float velocityBY = b != UINT_MAX ? velocityY[b] : 0.0f;
+
+		//Friction, clamped by the normal impulse
+		float relativeX = velocityBX - velocityAX;
+		float relativeY = velocityBY - velocityAY;
+		const float tangentSpeed = relativeY * normalX - relativeX * normalY;
+		const float maxFriction = constraint.friction * constraint.normalImpulse;
+		float tangentImpulse = constraint.tangentImpulse - tangentSpeed * constraint.tangentMass;
+		tangentImpulse = tangentImpulse < -maxFriction ? -maxFriction : (tangentImpulse > maxFriction ? maxFriction : tangentImpulse);
+		float impulse = tangentImpulse - constraint.tangentImpulse;
+		constraint.tangentImpulse = tangentImpulse;
+		velocityAX += normalY * impulse * constraint.inverseMassA;
+		velocityAY -= normalX * impulse * constraint.inverseMassA;
+		velocityBX -= normalY * impulse * constraint.inverseMassB;
+		velocityBY += normalX * impulse * constraint.inverseMassB;
+
+		//Normal, only pushes apart
+		relativeX = velocityBX - velocityAX;
+		relativeY = velocityBY - velocityAY;
+		const float normalSpeed = relativeX * normalX + relativeY * normalY;
+		float normalImpulse = constraint.normalImpulse + (constraint.bias - normalSpeed) * constraint.normalMass;
+		if (normalImpulse < 0.0f)
+			normalImpulse = 0.0f;
+		impulse = normalImpulse - constraint.normalImpulse;
+		constraint.normalImpulse = normalImpulse;
+		velocityAX -= normalX * impulse * constraint.inverseMassA;
+		velocityAY -= normalY * impulse * constraint.inverseMassA;
+		velocityBX += normalX * impulse * constraint.inverseMassB;
+		velocityBY += normalY * impulse * constraint.inverseMassB;
+
+		if (constraint.inverseMassA > 0.0f)
+		{
+			velocityX[a] = velocityAX;
+			velocityY[a] = velocityAY;
+		}
+		if (constraint.inverseMassB > 0.0f)
+		{
+			velocityX[b] = velocityBX;
+			velocityY[b] = velocityBY;
+		}
+	}
+	void PhysicsWorld::sweepBullets(float deltaTime)
+	{
+		timeOfImpact.assign(owners.size(), 1.0f);
+		for (unsigned b = 0; b < bulletBoxes.size(); b++)
+		{
+			CollisionBox* box = bulletBoxes[b];
+			const unsigned body = findBody(box);
+			if (body == UINT_MAX || !awake[body] || inverseMass[body] == 0.0f)
+				continue;
+			const glm::vec2 displacement(velocityX[body] * deltaTime, velocityY[body] * deltaTime);
+			const OrientedBox& orientedBox = box->getOrientedBox();
+			//Moves shorter than half the box end up overlapping whatever they would pass, the contacts handle those
+			const float halfSize = orientedBox.halfSize.x < orientedBox.halfSize.y ? orientedBox.halfSize.x : orientedBox.halfSize.y;
+			if (displacement.x * displacement.x + displacement.y * displacement.y <= halfSize * halfSize)
+				continue;
+			const AABB bounds = orientedBox.getBounds();
+
+			sweepHits.clear();
+			getBroadphase()->querySweep(bounds, displacement, sweepHits, box->getMask());
+			GameObject* object = box->getGameObject();
+			for (unsigned h = 0; h < sweepHits.size(); h++)
+			{
+				//The bounds touch no later than the boxes, so the bounds' fraction rules out hits that can't be first
+				CollisionBox* other = sweepHits[h].box;
+				if (sweepHits[h].fraction >= timeOfImpact[body] || other->getGameObject() == object || !box->canCollide(*other))
+					continue;
+				const unsigned otherBody = findBody(other);
+				if (otherBody != UINT_MAX && awake[otherBody] && inverseMass[otherBody] > 0.0f)
+					continue;//Moving bodies are only caught by the contacts
+				//Rotated boxes can be far apart while their bounds touch, sweep the boxes themselves
+				float fraction;
+				if (!other->getOrientedBox().sweep(orientedBox, displacement, fraction) || fraction <= 0.0f)
+					continue;//Missed, or already overlapping and left to the contacts
+				if (fraction < timeOfImpact[body])
+					timeOfImpact[body] = fraction;
+			}
+		}
+	}
+	void PhysicsWorld::integratePositions(float deltaTime)
+	{
+		const unsigned count = owners.size();
+		for (unsigned i = 0; i < count; i++)
+		{
+			if (!awake[i])
+				continue;
+			GameObject* object = owners[i]->getGameObject();
+			if (object == nullptr || !object->hasTransform())
+				continue;//Prefab prototypes and bodies without a transform
+			Transform& transform = object->transform();
+			//Bullets stop where they touch, the contact takes over in the next substep
+			const float moveTime = deltaTime * timeOfImpact[i];
+			if (velocityX[i] != 0.0f || velocityY[i] != 0.0f)
+				transform.move(velocityX[i] * moveTime, velocityY[i] * moveTime);
+			if (angularVelocity[i] != 0.0f)
+				transform.rotate(angularVelocity[i] * deltaTime);
+		}
+	}
+	void PhysicsWorld::updateSleep(float deltaTime)
+	{
+		const unsigned count = owners.size();
+		for (unsigned i = 0; i < count; i++)
+		{
+			if (!awake[i])
+				continue;
+			const float speedSquared = velocityX[i] * velocityX[i] + velocityY[i] * velocityY[i];
+			//Kinematic bodies move at exactly the velocity they are given, slow platforms would stop for good if they slept
+			const bool moving = inverseMass[i] == 0.0f ? speedSquared > 0.0f || angularVelocity[i] != 0.0f :
+				speedSquared > PHYSICS_SLEEP_LINEAR * PHYSICS_SLEEP_LINEAR || std::fabs(angularVelocity[i]) > PHYSICS_SLEEP_ANGULAR;
+			if (!sleepingAllowed[i] || moving)
+			{
+				sleepTime[i] = 0.0f;
+				continue;
+			}
+			sleepTime[i] += deltaTime;
+			if (bodyIslands[i] == UINT_MAX && sleepTime[i] >= GINES_PHYSICS_TIME_TO_SLEEP)
+				sleepIndex(i);//Stopped kinematic bodies sleep on their own
+		}
+
+		//Islands sleep together, once the body that moved last has been still long enough
+		const unsigned islandCount = islandBodyStart.size() - 1;
+		for (unsigned island = 0; island < islandCount; island++)
+		{
+			bool still = true;
+			for (unsigned i = islandBodyStart[island]; i < islandBodyStart[island + 1] && still; i++)
+				still = sleepTime[islandBodies[i]] >= GINES_PHYSICS_TIME_TO_SLEEP;
+			if (!still)
+				continue;
+			for (unsigned i = islandBodyStart[island]; i < islandBodyStart[island + 1]; i++)
+				sleepIndex(islandBodies[i]);
+		}
+	}
+	void PhysicsWorld::sleepIndex(unsigned i)
+	{
+		awake[i] = 0;
+		velocityX[i] = 0.0f;
+		velocityY[i] = 0.0f;
+		angularVelocity[i] = 0.0f;
+	}
+
+	PhysicsWorld& getPhysicsWorld()
+	{
+		static PhysicsWorld* world = new PhysicsWorld();//Outlives every body, including static ones
+		return *world;
+	}
+	void updatePhysics(float seconds)
+	{
+		getPhysicsWorld().update(seconds);
+	}
+	bool initializePhysics()
+	{
+		console.addVariable("physicsSubsteps", physicsSubsteps);
+		return true;
+	}
+}
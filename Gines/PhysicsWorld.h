@@ -0,0 +1,182 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <glm/vec2.hpp>
+#include "Narrowphase.h"
+
+#define GINES_PHYSICS_TIMESTEP (1.0f / 60.0f)	//Seconds per fixed step
+#define GINES_PHYSICS_MAX_STEPS 4				//Most steps run in one frame, time beyond that is dropped
+#define GINES_PHYSICS_ITERATIONS 8				//Velocity solver iterations per substep
+#define GINES_PHYSICS_GRAVITY -980.0f			//World units per second squared along y
+#define GINES_PHYSICS_TIME_TO_SLEEP 0.5f		//Seconds a body has to stay still before it sleeps
+#define GINES_PHYSICS_COLORING_THRESHOLD 256	//Islands with at least this many contacts are colored and solved in parallel
+
+/*
+Rigid body simulation for PhysicsComponent. Bodies collide through the collision boxes on their game object,
+boxes on objects without a body are static. updatePhysics() runs fixed steps, it is called from beginMainLoop().
+Bodies move the local position of their transform, so they should not be children of moving objects.
+Contacts push bodies apart and apply friction but don't make them rotate, angular velocity is only what is set on the body.
+
+Each substep groups the awake bodies into islands: bodies connected through contacts, static and kinematic bodies
+don't connect islands. Islands share no solved body, so they are solved in parallel on the job system. Islands with
+at least GINES_PHYSICS_COLORING_THRESHOLD contacts are colored: contacts of one color share no body and are solved
+in parallel, one color after the other. Which islands are colored only depends on their size, and every contact
+is solved in the same order, so the results don't depend on the number of worker threads.
+Islands fall asleep as a whole once all of their bodies have been still long enough.
+
+Fast bodies can pass through thin boxes between two substeps. Bullet collision boxes (CollisionBox::setBullet) are
+swept along the body's movement instead, and the body stops where they first touch a box that isn't on an awake
+dynamic body. Use bullets on the few objects that need them rather than raising physicsSubsteps for the whole world.
+*/
+namespace gines
+{
+	class PhysicsComponent;
+	class GameObject;
+	class CollisionBox;
+
+	//Variables that should be visible outside
+	extern int physicsSubsteps;//Substeps per fixed step
+
+	class PhysicsWorld
+	{
+	public:
+		PhysicsWorld();
+		~PhysicsWorld();
+
+		//Bodies are packed, the last body is moved into the hole on removal. Ids stay valid until removed
+		unsigned add(PhysicsComponent* owner);
+		void remove(unsigned id);
+		bool contains(unsigned id);
+		void copy(unsigned from, unsigned to);//Everything except the owner
+		unsigned getBodyCount(){ return owners.size(); }
+
+		//Runs the fixed steps that fit in the elapsed time, then clears the forces
+		void update(float seconds);
+		void step(float timestep);//Keeps the forces, call clearForces() after stepping by hand
+		void clearForces();
+		void setTimestep(float seconds){ timestep = seconds; }
+		float getTimestep(){ return timestep; }
+		void setGravity(glm::vec2 _gravity){ gravity = _gravity; }
+		glm::vec2 getGravity(){ return gravity; }
+
+		//Body access by id
+		glm::vec2 getVelocity(unsigned id){ unsigned i = dense[id]; return glm::vec2(velocityX[i], velocityY[i]); }
+		void setVelocity(unsigned id, glm::vec2 velocity);
+		float getAngularVelocity(unsigned id){ return angularVelocity[dense[id]]; }
+		void setAngularVelocity(unsigned id, float velocity);
+		void addForce(unsigned id, glm::vec2 force);
+		void addImpulse(unsigned id, glm::vec2 impulse);
+		float getMass(unsigned id){ unsigned i = dense[id]; return inverseMass[i] > 0.0f ? 1.0f / inverseMass[i] : 0.0f; }
+		void setMass(unsigned id, float mass);
+		float getRestitution(unsigned id){ return restitution[dense[id]]; }
+		void setRestitution(unsigned id, float value){ restitution[dense[id]] = value; }
+		float getFriction(unsigned id){ return friction[dense[id]]; }
+		void setFriction(unsigned id, float value){ friction[dense[id]] = value; }
+		float getGravityScale(unsigned id){ return gravityScale[dense[id]]; }
+		void setGravityScale(unsigned id, float scale){ gravityScale[dense[id]] = scale; }
+		bool isAwake(unsigned id){ return awake[dense[id]] != 0; }
+		void wakeUp(unsigned id);
+		void sleep(unsigned id);//Stops simulating the body until it is woken up, the velocity is kept
+		void setSleepingAllowed(unsigned id, bool allowed);
+		bool isSleepingAllowed(unsigned id){ return sleepingAllowed[dense[id]] != 0; }
+
+		/*Body component of the object, nullptr if it has none. Classes derived from PhysicsComponent are only searched for
+		with getComponentDerived while bodies of such classes exist, so objects without a body are a slot table miss*/
+		PhysicsComponent* findComponent(GameObject* object);
+
+	private:
+		PhysicsWorld(const PhysicsWorld&);
+		void operator=(const PhysicsWorld&);
+
+		//Solver contact between two bodies, or a body and a static box. Body indices are UINT_MAX for static boxes
+		struct ContactConstraint
+		{
+			CollisionBox* boxA;
+			CollisionBox* boxB;
+			unsigned bodyA;
+			unsigned bodyB;
+			glm::vec2 normal;//From A towards B
+			float depth;
+			float inverseMassA;
+			float inverseMassB;
+			float normalMass;
+			float tangentMass;
+			float friction;
+			float bias;//Target separating velocity
+			float normalImpulse;//Accumulated, kept between steps for warm starting
+			float tangentImpulse;
+		};
+		void substep(float deltaTime);
+		void buildConstraints(float deltaTime);
+		void buildIslands();
+		void solveIslands();
+		void solveIsland(unsigned island);//Serially, in contact order
+		void solveColoredIsland(unsigned island);
+		void warmStart(ContactConstraint& constraint);
+		void solve(ContactConstraint& constraint);
+		void sweepBullets(float deltaTime);//Time of impact of each body with bullet boxes
+		void integratePositions(float deltaTime);
+		void updateSleep(float deltaTime);
+		unsigned findBody(CollisionBox* box);
+		unsigned findRoot(unsigned body);
+		static bool constraintLess(const ContactConstraint& left, const ContactConstraint& right);//Box pair order
+		void wakeIndex(unsigned i);
+		void sleepIndex(unsigned i);
+
+		float timestep = GINES_PHYSICS_TIMESTEP;
+		float accumulator = 0.0f;
+		glm::vec2 gravity;
+
+		//Body data
+		std::vector<float> velocityX;
+		std::vector<float> velocityY;
+		std::vector<float> angularVelocity;
+		std::vector<float> forceX;
+		std::vector<float> forceY;
+		std::vector<float> inverseMass;
+		std::vector<float> restitution;
+		std::vector<float> friction;
+		std::vector<float> gravityScale;
+		std::vector<float> sleepTime;
+		std::vector<unsigned char> awake;
+		std::vector<unsigned char> sleepingAllowed;
+		std::vector<PhysicsComponent*> owners;
+		std::vector<unsigned> ids;
+		std::vector<unsigned> dense;//Index of each id
+		std::vector<unsigned> freeIds;
+		bool bodyTypesDirty = true;//Bodies were added or removed since derivedBodies was counted
+		bool derivedBodies = false;//Some body is a class derived from PhysicsComponent
+
+		//Step scratch
+		std::vector<CollisionPair> pairs;
+		std::vector<CollisionPair> bodyPairs;
+		std::vector<Contact> contacts;
+		std::vector<ContactConstraint> constraints;//Sorted by box pair
+		std::vector<ContactConstraint> previousConstraints;
+		std::vector<float> timeOfImpact;//Fraction of the substep each body moves
+		std::vector<RayHit> sweepHits;
+
+		//Islands, rebuilt every substep. Bodies and contacts of island i are at [start[i], start[i + 1]) of the lists
+		std::vector<unsigned> islandParents;//Union-find over body indices
+		std::vector<unsigned> bodyIslands;//Island of each body, UINT_MAX when asleep or not dynamic
+		std::vector<unsigned> islandBodyStart;
+		std::vector<unsigned> islandBodies;
+		std::vector<unsigned> islandConstraintStart;
+		std::vector<unsigned> islandConstraints;
+		std::vector<unsigned> smallIslands;//Islands with contacts, below the coloring threshold
+		std::vector<unsigned> largeIslands;
+		std::vector<unsigned> islandCursor;
+
+		//Coloring scratch of the large island being solved
+		std::vector<uint64_t> bodyColors;//Colors used by each body's contacts
+		std::vector<unsigned> constraintColors;
+		std::vector<unsigned> colorStart;
+		std::vector<unsigned> colorConstraints;
+		std::vector<unsigned> overflowConstraints;//Contacts that found no free color, solved serially after the colors
+	};
+	PhysicsWorld& getPhysicsWorld();
+	//Steps the physics world with the frame time, called from beginMainLoop()
+	void updatePhysics(float seconds);
+	bool initializePhysics();
+}
@@ -0,0 +1,86 @@
+#include "Pool.h"
+#include "Error.hpp"
+
+namespace gines
+{
+	static std::vector<PoolAllocator*>& pools()
+	{
+		static std::vector<PoolAllocator*> allPools;
+		return allPools;
+	}
+
+	PoolAllocator::PoolAllocator(std::string poolName, size_t size, size_t alignment) : name(poolName)
+	{
+		//Blocks must be able to hold the free list pointer and keep the object aligned
+		if (alignment < sizeof(void*))
+			alignment = sizeof(void*);
+		if (size < sizeof(void*))
+			size = sizeof(void*);
+		objectSize = (size + alignment - 1) / alignment * alignment;
+		pools().push_back(this);
+	}
+	PoolAllocator::~PoolAllocator()
+	{
+		if (liveCount != 0)
+		{
+			Message(("Pool " + name + " destroyed with live objects!").c_str(), gines::Message::Warning);
+		}
+		for (unsigned i = 0; i < slabs.size(); i++)
+		{
+			::operator delete(slabs[i]);
+		}
+		std::vector<PoolAllocator*>& all = pools();
+		for (unsigned i = 0; i < all.size(); i++)
+		{
+			if (all[i] == this)
+			{
+				all.erase(all.begin() + i);
+				break;
+			}
+		}
+	}
+	void PoolAllocator::addSlab()
+	{
+		char* slab = static_cast<char*>(::operator new(objectSize * GINES_POOL_SLAB_SIZE));
+		slabs.push_back(slab);
+		//Link the blocks in address order so that consecutive allocations are adjacent in memory
+		for (int i = GINES_POOL_SLAB_SIZE - 1; i >= 0; i--)
+		{
+			void* block = slab + i * objectSize;
+			*static_cast<void**>(block) = freeList;
+			freeList = block;
+		}
+	}
+	void* PoolAllocator::allocate()
+	{
+		if (freeList == nullptr)
+		{
+			addSlab();
+		}
+		void* block = freeList;
+		freeList = *static_cast<void**>(block);
+		liveCount++;
+		return block;
+	}
+	void PoolAllocator::free(void* pointer)
+	{
+		if (pointer == nullptr)
+		{
+			return;
+		}
+		*static_cast<void**>(pointer) = freeList;
+		freeList = pointer;
+		liveCount--;
+	}
+	void PoolAllocator::reserve(unsigned count)
+	{
+		while (getCapacity() < count)
+		{
+			addSlab();
+		}
+	}
+	const std::vector<PoolAllocator*>& PoolAllocator::getPools()
+	{
+		return pools();
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <typeinfo>
+#include <type_traits>
+#include <cstddef>
+
+#define GINES_POOL_SLAB_SIZE 256	//Objects per slab
+
+namespace gines
+{
+	/*Slab allocator for objects of one size. Freed blocks go to a free list and are reused before a new slab is allocated.
+	Slabs are only released when the pool is destroyed, so addresses of live objects never change.
+	Not thread safe, allocate and free from the main thread.*/
+	class PoolAllocator
+	{
+	public:
+		PoolAllocator(std::string poolName, size_t size, size_t alignment);
+		~PoolAllocator();
+
+		void* allocate();
+		void free(void* pointer);
+		void reserve(unsigned count);//Makes sure that count objects can be live without allocating new slabs
+
+		//Stats
+		const std::string& getName(){ return name; }
+		unsigned getLiveCount(){ return liveCount; }
+		unsigned getCapacity(){ return slabs.size() * GINES_POOL_SLAB_SIZE; }
+		unsigned getSlabCount(){ return slabs.size(); }
+		size_t getObjectSize(){ return objectSize; }
+
+		//All pools that currently exist, for stats reporting
+		static const std::vector<PoolAllocator*>& getPools();
+
+	private:
+		PoolAllocator(const PoolAllocator&);
+		void operator=(const PoolAllocator&);
+		void addSlab();
+
+		std::string name;
+		size_t objectSize;
+		unsigned liveCount = 0;
+		void* freeList = nullptr;//Free blocks store the pointer to the next free block in their first bytes
+		std::vector<char*> slabs;
+	};
+
+	/*Returns the pool used for objects of type T.
+	Type pools live until the process exits so that objects destroyed during static destruction can still be freed*/
+	template <typename T>
+	PoolAllocator& getPool()
+	{
+		static PoolAllocator* pool = new PoolAllocator(typeid(T).name(), sizeof(T), std::alignment_of<T>::value);
+		return *pool;
+	}
+}
@@ -0,0 +1,143 @@
+#include "Prefab.h"
+#include <climits>
+
+namespace gines
+{
+	Prefab::Prefab()
+	{
+	}
+	Prefab::Prefab(GameObject* source)
+	{
+		capture(source);
+	}
+	Prefab::~Prefab()
+	{
+		clear();
+	}
+
+	void Prefab::clear()
+	{
+		for (unsigned n = 0; n < nodes.size(); n++)
+		{
+			for (unsigned i = 0; i < nodes[n].prototypes.size(); i++)
+			{
+				GameObject::destroyComponent(nodes[n].prototypes[i]);
+			}
+		}
+		nodes.clear();
+		typeCounts.clear();
+	}
+	void Prefab::capture(GameObject* source)
+	{
+		clear();
+		if (source != nullptr)
+			captureObject(source, UINT_MAX);
+	}
+	void Prefab::captureObject(GameObject* object, unsigned parentNode)
+	{
+		unsigned index = nodes.size();
+		nodes.push_back(Node());
+		nodes[index].name = object->name;
+		nodes[index].parent = parentNode;
+
+		for (unsigned i = 0; i < object->components.size(); i++)
+		{
+			Component* component = object->components[i];
+			GameObject::ComponentTypeInfo& info = GameObject::getComponentTypeInfo(component->typeId);
+			if (info.clone == nullptr)
+			{
+				Message("Prefab: component type can't be copied, it is left out", gines::Message::Warning);
+				continue;
+			}
+			Component* prototype = info.clone(*component, info.pool->allocate());
+			prototype->pool = info.pool;
+			prototype->typeId = component->typeId;
+			prototype->onPrefabPrototype();
+			nodes[index].prototypes.push_back(prototype);
+
+			if (component->typeId >= typeCounts.size())
+				typeCounts.resize(component->typeId + 1, 0);
+			typeCounts[component->typeId]++;
+		}
+
+		for (unsigned i = 0; i < object->children.size(); i++)
+		{
+			captureObject(object->children[i], index);
+		}
+	}
+
+	GameObject* Prefab::instantiate(GameObject* parent)
+	{
+		std::vector<GameObject*> instances;
+		instantiate(1, parent, &instances);
+		return instances.empty() ? nullptr : instances[0];
+	}
+	void Prefab::instantiate(unsigned count, GameObject* parent, std::vector<GameObject*>* instances)
+	{
+		if (count == 0 || nodes.empty())
+			return;
+
+		//Size everything once
+		const unsigned objectCount = count * nodes.size();
+		GameObject::reserve(objectCount);
+		getPool<GameObject>().reserve(getPool<GameObject>().getLiveCount() + objectCount);
+		for (unsigned type = 0; type < typeCounts.size(); type++)
+		{
+			if (typeCounts[type] > 0)
+			{
+				PoolAllocator* pool = GameObject::getComponentTypeInfo(type).pool;
+				pool->reserve(pool->getLiveCount() + count * typeCounts[type]);
+			}
+		}
+		if (parent != nullptr)
+			parent->children.reserve(parent->children.size() + count);
+		if (instances != nullptr)
+			instances->reserve(instances->size() + count);
+
+		std::vector<GameObject*> created(nodes.size());
+		std::vector<unsigned> nameIds(nodes.size(), UINT_MAX);
+		for (unsigned copy = 0; copy < count; copy++)
+		{
+			for (unsigned n = 0; n < nodes.size(); n++)
+			{
+				Node& node = nodes[n];
+				GameObject* object;
+				if (nameIds[n] == UINT_MAX)
+				{//First copy interns the name, the rest reuse the id
+					object = new GameObject(node.name);
+					nameIds[n] = object->nameId;
+					GameObject::reserveName(nameIds[n], count - 1);
+				}
+				else
+				{
+					object = new GameObject(GameObject::InternedName(nameIds[n]));
+				}
+
+				object->components.reserve(node.prototypes.size());
+				for (unsigned i = 0; i < node.prototypes.size(); i++)
+				{
+					Component* prototype = node.prototypes[i];
+					GameObject::ComponentTypeInfo& info = GameObject::getComponentTypeInfo(prototype->typeId);
+					Component* component = info.clone(*prototype, info.pool->allocate());
+					component->pool = info.pool;
+					if (info.transform)
+						object->setTransformComponent(static_cast<Transform*>(component), std::true_type());
+					object->attachComponent(component, prototype->typeId, info.updates, info.renders);
+				}
+
+				if (node.parent != UINT_MAX)
+				{
+					created[node.parent]->addChild(object);
+				}
+				else
+				{
+					if (parent != nullptr)
+						parent->addChild(object);
+					if (instances != nullptr)
+						instances->push_back(object);
+				}
+				created[n] = object;
+			}
+		}
+	}
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include "GameObject.h"
+
+/*
+Captured copy of a game object subtree that can be instantiated any number of times:
+
+	gines::Prefab enemyPrefab(enemyTemplate);//Component data is copied here, enemyTemplate can be destroyed afterwards
+	std::vector<gines::GameObject*> wave;
+	enemyPrefab.instantiate(10000, level, &wave);
+
+Components are copied with their copy constructors. Types that can't be copied are left out with a warning.
+Instances share the names of the captured objects.
+*/
+namespace gines
+{
+	class Prefab
+	{
+	public:
+		Prefab();
+		Prefab(GameObject* source);
+		~Prefab();
+
+		void capture(GameObject* source);//Replaces the previous capture
+		void clear();
+		GameObject* instantiate(GameObject* parent = nullptr);
+		/*Creates count copies in one go. Pools, the game object registry and the parent's children are sized once up front.
+		The root object of each copy is appended to instances if given*/
+		void instantiate(unsigned count, GameObject* parent = nullptr, std::vector<GameObject*>* instances = nullptr);
+		unsigned getObjectCount(){ return nodes.size(); }//Objects per copy
+
+	private:
+		Prefab(const Prefab&);
+		void operator=(const Prefab&);
+		void captureObject(GameObject* object, unsigned parentNode);
+
+		struct Node
+		{
+			std::string name;
+			unsigned parent;//Index of the parent node, UINT_MAX for the root
+			std::vector<Component*> prototypes;//Copies of the components, not attached to any object
+		};
+		std::vector<Node> nodes;//Parents come before their children
+		std::vector<unsigned> typeCounts;//Components of each type id per copy
+	};
+}
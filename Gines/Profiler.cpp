@@ -0,0 +1,297 @@
+#include <SDL\SDL_timer.h>
+#include <GL/glew.h>
+#include <glm/gtc/type_ptr.hpp>//glm::value_ptr
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include <string>
+
+#include "Profiler.h"
+#include "Gines.h"
+#include "Text.h"
+#include "Camera.h"
+#include "Vertex.h"
+#include "GameObject.h"
+#include "Pool.h"
+
+#define PERF_GRAPH_SAMPLES 240	//Number of frames shown in the frame time graph
+#define PERF_GRAPH_HEIGHT 80	//Graph height in pixels
+#define PERF_GRAPH_STEP 2		//Horizontal pixels per sample
+#define PERF_GRAPH_SCALE 33.3f	//Frame time (ms) at the top of the graph
+#define PERF_REFRESH_RATE 10	//Frames between HUD text updates
+#define PERF_FONT_SIZE 16
+#define PERF_BORDER 5
+
+extern int WINDOW_WIDTH;
+extern int WINDOW_HEIGHT;
+
+namespace gines
+{
+	//Global variables
+	extern char* ginesFontPath;
+	extern GLSLProgram colorProgram;
+	PerformanceCounters perfCounters;
+	bool showPerf = false;
+	bool showPerfDraws = false;
+	bool showPerfMem = false;
+
+	//Local variables
+	static bool initialized = false;
+	static PerformanceCounters previousCounters;//Counters of the last completed frame
+	static Uint64 frameStartCounter = 0;
+	static float frameTimes[PERF_GRAPH_SAMPLES];//Ring buffer of frame times in milliseconds
+	static int frameTimeIndex = 0;
+	static int frameTimeCount = 0;
+	static GLuint graphVBO = 0;
+	static GLuint whiteTexture = 0;//Graph is drawn with the color program, which always samples a texture
+	static Text* frameText = nullptr;
+	static Text* drawsText = nullptr;
+	static Text* memText = nullptr;
+
+	static void updateHudText()
+	{
+		if (frameTimeCount == 0)
+		{
+			return;
+		}
+
+		//Percentiles from a sorted copy of the sample window
+		std::vector<float> sorted(frameTimes, frameTimes + frameTimeCount);
+		std::sort(sorted.begin(), sorted.end());
+		float average = 0;
+		for (unsigned i = 0; i < sorted.size(); i++)
+		{
+			average += sorted[i];
+		}
+		average /= sorted.size();
+		const unsigned last = sorted.size() - 1;
+		frameText->setString("frame ms avg " + std::to_string(average).substr(0, 5) +
+			" p50 " + std::to_string(sorted[unsigned(last * 0.50f)]).substr(0, 5) +
+			" p95 " + std::to_string(sorted[unsigned(last * 0.95f)]).substr(0, 5) +
+			" p99 " + std::to_string(sorted[unsigned(last * 0.99f)]).substr(0, 5) +
+			" max " + std::to_string(sorted[last]).substr(0, 5));
+
+		drawsText->setString("draws " + std::to_string(previousCounters.drawCalls) +
+			" binds " + std::to_string(previousCounters.textureBinds) +
+			" sprites " + std::to_string(previousCounters.sprites) +
+			" glyphs " + std::to_string(previousCounters.glyphs));
+
+		unsigned pooledLive = 0;
+		unsigned pooledCapacity = 0;
+		const std::vector<PoolAllocator*>& pools = PoolAllocator::getPools();
+		for (unsigned i = 0; i < pools.size(); i++)
+		{
+			pooledLive += pools[i]->getLiveCount();
+			pooledCapacity += pools[i]->getCapacity();
+		}
+		memText->setString("upload " + std::to_string(previousCounters.bufferBytes / 1024) + " KB" +
+			" objects " + std::to_string(GameObject::getGameObjectCount()) +
+			" components " + std::to_string(Component::getComponentCount()) +
+			" pooled " + std::to_string(pooledLive) + "/" + std::to_string(pooledCapacity));
+	}
+
+	static void perfCommand(std::vector<std::string>& words)
+	{
+		if (words.size() == 1)
+		{
+			showPerf = !showPerf;
+		}
+		else if (words[1] == "draws")
+		{
+			showPerfDraws = !showPerfDraws;
+		}
+		else if (words[1] == "mem")
+		{
+			showPerfMem = !showPerfMem;
+		}
+		else if (words[1] == "dump")
+		{//Log the HUD lines, useful when the console is driven from a script
+			updateHudText();
+			console.log(frameText->getString());
+			console.log(drawsText->getString());
+			console.log(memText->getString());
+		}
+		else if (words[1] == "pools")
+		{//Occupancy of each pool allocator
+			const std::vector<PoolAllocator*>& pools = PoolAllocator::getPools();
+			for (unsigned i = 0; i < pools.size(); i++)
+			{
+				console.log(pools[i]->getName() + " " + std::to_string(pools[i]->getLiveCount()) + "/" +
+					std::to_string(pools[i]->getCapacity()) + " in " + std::to_string(pools[i]->getSlabCount()) + " slabs");
+			}
+		}
+		else
+		{
+			console.log("Usage: perf [draws|mem|dump|pools]");
+		}
+	}
+
+	static Text* createHudText()
+	{
+		Text* text = new Text();
+		text->setFont(ginesFontPath, PERF_FONT_SIZE);
+		text->setColor(0.9f, 0.9f, 0.2f, 1.0f);
+		text->useCameras(false);
+		return text;
+	}
+
+	bool initializeProfiler()
+	{
+		Message("Profiler initialization started...", gines::Message::Info);
+		if (initialized)
+		{
+			Message("Profiler already initialized!", gines::Message::Info);
+			return true;
+		}
+
+		frameText = createHudText();
+		drawsText = createHudText();
+		memText = createHudText();
+
+		glGenBuffers(1, &graphVBO);
+		const GLubyte white[4] = { 255, 255, 255, 255 };
+		glGenTextures(1, &whiteTexture);
+		glBindTexture(GL_TEXTURE_2D, whiteTexture);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glBindTexture(GL_TEXTURE_2D, 0);
+
+		console.addConsoleCommand("perf", perfCommand);
+		console.addVariable("showPerf", showPerf);
+		console.addVariable("showPerfDraws", showPerfDraws);
+		console.addVariable("showPerfMem", showPerfMem);
+
+		Message("Profiler initialized successfully!", gines::Message::Info);
+		initialized = true;
+		return true;
+	}
+	void uninitializeProfiler()
+	{
+		if (!initialized)
+		{
+			return;
+		}
+		delete frameText;
+		delete drawsText;
+		delete memText;
+		frameText = drawsText = memText = nullptr;
+		glDeleteBuffers(1, &graphVBO);
+		glDeleteTextures(1, &whiteTexture);
+		initialized = false;
+	}
+
+	void beginProfilerFrame()
+	{
+		frameStartCounter = SDL_GetPerformanceCounter();
+		perfCounters.reset();
+	}
+	void endProfilerFrame()
+	{
+		Uint64 elapsed = SDL_GetPerformanceCounter() - frameStartCounter;
+		frameTimes[frameTimeIndex] = float(elapsed * 1000.0 / SDL_GetPerformanceFrequency());
+		frameTimeIndex = (frameTimeIndex + 1) % PERF_GRAPH_SAMPLES;
+		if (frameTimeCount < PERF_GRAPH_SAMPLES)
+		{
+			frameTimeCount++;
+		}
+		previousCounters = perfCounters;
+	}
+
+	static void drawGraph(const glm::vec2& bottomLeft)
+	{
+		//Oldest sample on the left, the whole graph is a single line strip
+		VertexPositionColorTexture vertices[PERF_GRAPH_SAMPLES];
+		const int first = frameTimeCount < PERF_GRAPH_SAMPLES ? 0 : frameTimeIndex;
+		for (int i = 0; i < frameTimeCount; i++)
+		{
+			float ms = frameTimes[(first + i) % PERF_GRAPH_SAMPLES];
+			float height = std::min(ms / PERF_GRAPH_SCALE, 1.0f) * PERF_GRAPH_HEIGHT;
+			vertices[i].position = glm::vec2(bottomLeft.x + i * PERF_GRAPH_STEP, bottomLeft.y + height);
+			vertices[i].uv = glm::vec2(0.0f, 0.0f);
+			//Green under 60 fps budget, red above
+			if (ms <= 1000.0f / 60.0f)
+				vertices[i].color = glm::vec4(0.1f, 0.9f, 0.1f, 1.0f);
+			else
+				vertices[i].color = glm::vec4(0.9f, 0.1f, 0.1f, 1.0f);
+		}
+
+		colorProgram.use();
+		glActiveTexture(GL_TEXTURE0);
+		glUniform1i(colorProgram.getUniformLocation("texture1"), 0);
+		guiCamera.enableViewport();
+		glUniformMatrix4fv(colorProgram.getUniformLocation("projection"), 1, GL_FALSE, glm::value_ptr(guiCamera.getCameraMatrix()));
+		glBindTexture(GL_TEXTURE_2D, whiteTexture);
+
+		glBindBuffer(GL_ARRAY_BUFFER, graphVBO);
+		glBufferData(GL_ARRAY_BUFFER, frameTimeCount * sizeof(VertexPositionColorTexture), vertices, GL_DYNAMIC_DRAW);
+
+		glEnableVertexAttribArray(0);
+		glEnableVertexAttribArray(1);
+		glEnableVertexAttribArray(2);
+		glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(VertexPositionColorTexture), (void*)offsetof(VertexPositionColorTexture, position));
+		glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(VertexPositionColorTexture), (void*)offsetof(VertexPositionColorTexture, color));
+		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(VertexPositionColorTexture), (void*)offsetof(VertexPositionColorTexture, uv));
+
+		glDrawArrays(GL_LINE_STRIP, 0, frameTimeCount);
+
+		glDisableVertexAttribArray(0);
+		glDisableVertexAttribArray(1);
+		glDisableVertexAttribArray(2);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glBindTexture(GL_TEXTURE_2D, 0);
+		colorProgram.unuse();
+	}
+
+	static void placeHudText(Text* text, float x, float y)
+	{
+		//Text::setPosition rebuilds the vertex buffer, only move when the layout changed
+		glm::vec2 position(x, y);
+		if (text->getPosition() != position)
+		{
+			text->setPosition(position);
+		}
+	}
+
+	void drawProfiler()
+	{
+		if (!initialized || !(showPerf || showPerfDraws || showPerfMem))
+		{
+			return;
+		}
+
+		static int frameCounter = 0;
+		if (++frameCounter >= PERF_REFRESH_RATE)
+		{
+			updateHudText();
+			frameCounter = 0;
+		}
+
+		//HUD is stacked downwards from the top right corner
+		float x = float(WINDOW_WIDTH - PERF_GRAPH_SAMPLES * PERF_GRAPH_STEP - PERF_BORDER);
+		float y = float(WINDOW_HEIGHT - PERF_BORDER);
+		if (showPerf)
+		{
+			y -= PERF_GRAPH_HEIGHT;
+			if (frameTimeCount > 1)
+			{
+				drawGraph(glm::vec2(x, y));
+			}
+			y -= frameText->getFontHeight();
+			placeHudText(frameText, x, y);
+			frameText->render();
+		}
+		if (showPerfDraws)
+		{
+			y -= drawsText->getFontHeight();
+			placeHudText(drawsText, x, y);
+			drawsText->render();
+		}
+		if (showPerfMem)
+		{
+			y -= memText->getFontHeight();
+			placeHudText(memText, x, y);
+			memText->render();
+		}
+	}
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "Error.hpp"
+#include <SDL\SDL_stdinc.h>
+
+namespace gines
+{
+	/*Per frame render counters. Reset by beginProfilerFrame(), incremented by the renderers*/
+	struct PerformanceCounters
+	{
+		void reset()
+		{
+			drawCalls = 0;
+			textureBinds = 0;
+			bufferBytes = 0;
+			sprites = 0;
+			glyphs = 0;
+		}
+		Uint32 drawCalls = 0;		//glDraw* calls
+		Uint32 textureBinds = 0;	//glBindTexture calls with a non zero texture
+		Uint32 bufferBytes = 0;		//Bytes uploaded with glBufferData/glBufferSubData
+		Uint32 sprites = 0;			//Sprites rendered (Sprite components and SpriteBatch entries)
+		Uint32 glyphs = 0;			//Text glyphs rendered
+	};
+
+	//Variables that should be visible outside
+	extern PerformanceCounters perfCounters;//Counters of the frame that is currently being processed
+	extern bool showPerf;		//Frame time graph and percentiles
+	extern bool showPerfDraws;	//Render counters
+	extern bool showPerfMem;	//Buffer uploads and live game object/component counts
+
+	bool initializeProfiler();
+	void uninitializeProfiler();
+	void beginProfilerFrame();
+	void endProfilerFrame();
+	void drawProfiler();
+}
@@ -0,0 +1,572 @@
+#include "QueryBatch.h"
+#include "CollisionBox.h"
+#include "JobSystem.h"
+#include "Simd.h"
+#include <algorithm>
+#include <cmath>
+
+#define QUERY_BATCH_BAND_MARGIN 0.01f	//Fraction of a cell that ray rows are widened by, covers rounding at the row edges
+#define QUERY_BATCH_TILES_PER_QUERY 64	//Tiles used to find the clusters, up to GINES_QUERY_BATCH_MAX_TILES
+
+namespace gines
+{
+	QueryBatch::QueryBatch() : resultStart(1, 0)
+	{
+	}
+	QueryBatch::~QueryBatch()
+	{
+	}
+
+	unsigned QueryBatch::addPoint(glm::vec2 point, unsigned layers)
+	{
+		kinds.push_back(Point);
+		a.push_back(point);
+		b.push_back(point);
+		layerBits.push_back(layers);
+		return kinds.size() - 1;
+	}
+	unsigned QueryBatch::addRect(const AABB& rect, unsigned layers)
+	{
+		kinds.push_back(Rect);
+		a.push_back(rect.min);
+		b.push_back(rect.max);
+		layerBits.push_back(layers);
+		return kinds.size() - 1;
+	}
+	unsigned QueryBatch::addRay(glm::vec2 from, glm::vec2 to, unsigned layers)
+	{
+		kinds.push_back(Ray);
+		a.push_back(from);
+		b.push_back(to);
+		layerBits.push_back(layers);
+		return kinds.size() - 1;
+	}
+	void QueryBatch::clear()
+	{
+		kinds.clear();
+		a.clear();
+		b.clear();
+		layerBits.clear();
+		resultStart.assign(1, 0);
+		resultBoxes.clear();
+		resultFractions.clear();
+	}
+
+	void QueryBatch::run(bool parallel)
+	{
+		const unsigned count = kinds.size();
+		resultStart.assign(count + 1, 0);
+		resultBoxes.clear();
+		resultFractions.clear();
+		if (count == 0)
+			return;
+		buildGrids();
+
+		//Every worker gets a few ranges of queries, each range collects its results in query order
+		unsigned grainSize = count;
+		if (parallel)
+		{
+			const unsigned rangeCount = (getWorkerCount() + 1) * 4;
+			grainSize = count / rangeCount > 0 ? count / rangeCount : 1;
+		}
+		const unsigned rangeCount = (count + grainSize - 1) / grainSize;
+		if (ranges.size() < rangeCount)
+			ranges.resize(rangeCount);
+		//parallelFor runs the whole span as one range when it doesn't split it, the other ranges would keep an earlier run's results
+		for (unsigned r = 0; r < rangeCount; r++)
+		{
+			ranges[r].entries.clear();
+			ranges[r].fractions.clear();
+		}
+		parallelFor(0, count, grainSize, [this, grainSize](unsigned begin, unsigned end) {
+			runRange(begin, end, ranges[begin / grainSize]);
+		});
+
+		//resultStart[i + 1] holds the result count of query i until here
+		for (unsigned i = 0; i < count; i++)
+			resultStart[i + 1] += resultStart[i];
+		resultBoxes.resize(resultStart[count]);
+		resultFractions.resize(resultStart[count]);
+		for (unsigned r = 0; r < rangeCount; r++)
+		{
+			const RangeResults& range = ranges[r];
+			const unsigned offset = resultStart[r * grainSize];
+			for (unsigned i = 0; i < range.entries.size(); i++)
+			{
+				resultBoxes[offset + i] = candidates[range.entries[i]];
+				resultFractions[offset + i] = range.fractions[i];
+			}
+		}
+	}
+
+	static AABB getQueryBounds(glm::vec2 a, glm::vec2 b)
+	{
+		return AABB(glm::vec2(a.x < b.x ? a.x : b.x, a.y < b.y ? a.y : b.y), glm::vec2(a.x > b.x ? a.x : b.x, a.y > b.y ? a.y : b.y));
+	}
+	//Columns and rows for about the given number of cells over the area, close to square
+	static void getGridShape(int cells, float width, float height, int& columns, int& rows)
+	{
+		if (cells < 1)
+			cells = 1;
+		columns = 1;
+		rows = 1;
+		if (width > 0.0f && height > 0.0f)
+		{
+			columns = int(std::sqrt(float(cells) * width / height));
+			columns = columns < 1 ? 1 : (columns > cells ? cells : columns);
+			rows = cells / columns;
+		}
+		else if (width > 0.0f)
+			columns = cells;
+		else if (height > 0.0f)
+			rows = cells;
+	}
+	static int getClampedIndex(float offset, float inverseSize, int count)
+	{
+		const int i = int(offset * inverseSize);
+		return i < 0 ? 0 : (i >= count ? count - 1 : i);
+	}
+	int QueryBatch::column(const Grid& grid, float x)
+	{
+		return getClampedIndex(x - grid.area.min.x, grid.inverseCellWidth, grid.columns);
+	}
+	int QueryBatch::row(const Grid& grid, float y)
+	{
+		return getClampedIndex(y - grid.area.min.y, grid.inverseCellHeight, grid.rows);
+	}
+
+	void QueryBatch::buildClusters()
+	{
+		const unsigned count = kinds.size();
+		AABB bounds = getQueryBounds(a[0], b[0]);
+		for (unsigned i = 1; i < count; i++)
+			bounds = bounds.merged(getQueryBounds(a[i], b[i]));
+
+		//A few tiles per query over the area of all queries
+		const float width = bounds.max.x - bounds.min.x;
+		const float height = bounds.max.y - bounds.min.y;
+		int tileColumns, tileRows;
+		getGridShape(count * QUERY_BATCH_TILES_PER_QUERY < GINES_QUERY_BATCH_MAX_TILES ? int(count * QUERY_BATCH_TILES_PER_QUERY) : GINES_QUERY_BATCH_MAX_TILES, width, height, tileColumns, tileRows);
+		const float inverseTileWidth = width > 0.0f ? float(tileColumns) / width : 0.0f;
+		const float inverseTileHeight = height > 0.0f ? float(tileRows) / height : 0.0f;
+
+		//Mark the tile rect of each query at its corners, the sums over the marks then count the queries over each tile
+		const int stride = tileColumns + 1;
+		tileCoverage.assign(stride * (tileRows + 1), 0);
+		for (unsigned i = 0; i < count; i++)
+		{
+			const AABB query = getQueryBounds(a[i], b[i]);
+			const int c0 = getClampedIndex(query.min.x - bounds.min.x, inverseTileWidth, tileColumns);
+			const int c1 = getClampedIndex(query.max.x - bounds.min.x, inverseTileWidth, tileColumns);
+			const int r0 = getClampedIndex(query.min.y - bounds.min.y, inverseTileHeight, tileRows);
+			const int r1 = getClampedIndex(query.max.y - bounds.min.y, inverseTileHeight, tileRows);
+			tileCoverage[r0 * stride + c0]++;
+			tileCoverage[r0 * stride + c1 + 1]--;
+			tileCoverage[(r1 + 1) * stride + c0]--;
+			tileCoverage[(r1 + 1) * stride + c1 + 1]++;
+		}
+		for (int r = 0; r < tileRows; r++)
+		{
+			for (int c = 0; c < tileColumns; c++)
+			{
+				int& coverage = tileCoverage[r * stride + c];
+				if (c > 0)
+					coverage += tileCoverage[r * stride + c - 1];
+				if (r > 0)
+					coverage += tileCoverage[(r - 1) * stride + c];
+				if (c > 0 && r > 0)
+					coverage -= tileCoverage[(r - 1) * stride + c - 1];
+			}
+		}
+
+		//Covered tiles in the first r rows and c columns, at r * stride + c
+		coveredTiles.assign(stride * (tileRows + 1), 0);
+		for (int r = 0; r < tileRows; r++)
+		{
+			for (int c = 0; c < tileColumns; c++)
+				coveredTiles[(r + 1) * stride + c + 1] = (tileCoverage[r * stride + c] > 0 ? 1 : 0) + coveredTiles[r * stride + c + 1] + coveredTiles[(r + 1) * stride + c] - coveredTiles[r * stride + c];
+		}
+
+		//Split the queries in half along the longer side of their area until most tiles of the area are covered
+		grids.clear();
+		queryGrids.resize(count);
+		clusterQueries.resize(count);
+		for (unsigned i = 0; i < count; i++)
+			clusterQueries[i] = i;
+		clusterRanges.assign(1, std::make_pair(0u, count));
+		while (!clusterRanges.empty())
+		{
+			const unsigned begin = clusterRanges.back().first;
+			const unsigned end = clusterRanges.back().second;
+			clusterRanges.pop_back();
+			AABB area = getQueryBounds(a[clusterQueries[begin]], b[clusterQueries[begin]]);
+			unsigned layers = layerBits[clusterQueries[begin]];
+			for (unsigned i = begin + 1; i < end; i++)
+			{
+				area = area.merged(getQueryBounds(a[clusterQueries[i]], b[clusterQueries[i]]));
+				layers |= layerBits[clusterQueries[i]];
+			}
+			const int c0 = getClampedIndex(area.min.x - bounds.min.x, inverseTileWidth, tileColumns);
+			const int c1 = getClampedIndex(area.max.x - bounds.min.x, inverseTileWidth, tileColumns);
+			const int r0 = getClampedIndex(area.min.y - bounds.min.y, inverseTileHeight, tileRows);
+			const int r1 = getClampedIndex(area.max.y - bounds.min.y, inverseTileHeight, tileRows);
+			const int covered = coveredTiles[(r1 + 1) * stride + c1 + 1] - coveredTiles[r0 * stride + c1 + 1] - coveredTiles[(r1 + 1) * stride + c0] + coveredTiles[r0 * stride + c0];
+			if (end - begin == 1 || covered * 2 >= (c1 - c0 + 1) * (r1 - r0 + 1))
+			{
+				Grid grid;
+				grid.area = area;
+				grid.layers = layers;
+				for (unsigned i = begin; i < end; i++)
+					queryGrids[clusterQueries[i]] = grids.size();
+				grids.push_back(grid);
+				continue;
+			}
+			//By the centers of the queries, a + b is twice the center
+			const unsigned middle = begin + (end - begin) / 2;
+			const bool splitX = area.max.x - area.min.x >= area.max.y - area.min.y;
+			std::nth_element(clusterQueries.begin() + begin, clusterQueries.begin() + middle, clusterQueries.begin() + end, [this, splitX](unsigned q1, unsigned q2) {
+				return splitX ? a[q1].x + b[q1].x < a[q2].x + b[q2].x : a[q1].y + b[q1].y < a[q2].y + b[q2].y;
+			});
+			clusterRanges.push_back(std::make_pair(begin, middle));
+			clusterRanges.push_back(std::make_pair(middle, end));
+		}
+	}
+	void QueryBatch::buildGrids()
+	{
+		buildClusters();
+
+		//Boxes in the area of each cluster, about one per cell with cells close to square
+		candidates.clear();
+		unsigned cellCount = 0;
+		for (unsigned g = 0; g < grids.size(); g++)
+		{
+			Grid& grid = grids[g];
+			grid.candidateBegin = candidates.size();
+			getBroadphase()->queryRect(grid.area, candidates, grid.layers);
+			grid.candidateEnd = candidates.size();
+			const unsigned count = grid.candidateEnd - grid.candidateBegin;
+			const float width = grid.area.max.x - grid.area.min.x;
+			const float height = grid.area.max.y - grid.area.min.y;
+			getGridShape(count < GINES_QUERY_BATCH_MAX_CELLS ? int(count) : GINES_QUERY_BATCH_MAX_CELLS, width, height, grid.columns, grid.rows);
+			grid.inverseCellWidth = width > 0.0f ? float(grid.columns) / width : 0.0f;
+			grid.inverseCellHeight = height > 0.0f ? float(grid.rows) / height : 0.0f;
+			grid.firstCell = cellCount;
+			cellCount += grid.columns * grid.rows + 1;
+		}
+		orientedBoxes.resize(candidates.size());
+		for (unsigned i = 0; i < candidates.size(); i++)
+			orientedBoxes[i] = candidates[i]->getOrientedBox();//Refreshes the box's cache here rather than from the workers
+
+		//Count the entries of each cell, boxes over too many cells go to the extra cell at the end of their grid
+		cellStart.assign(cellCount + 1, 0);
+		for (unsigned g = 0; g < grids.size(); g++)
+		{
+			const Grid& grid = grids[g];
+			const unsigned extraCell = grid.firstCell + grid.columns * grid.rows;
+			for (unsigned i = grid.candidateBegin; i < grid.candidateEnd; i++)
+			{
+				const AABB bounds = orientedBoxes[i].getBounds();
+				const int c0 = column(grid, bounds.min.x), c1 = column(grid, bounds.max.x);
+				const int r0 = row(grid, bounds.min.y), r1 = row(grid, bounds.max.y);
+				if ((c1 - c0 + 1) * (r1 - r0 + 1) > GINES_QUERY_BATCH_MAX_SPAN)
+				{
+					cellStart[extraCell + 1]++;
+					continue;
+				}
+				for (int r = r0; r <= r1; r++)
+				{
+					for (int c = c0; c <= c1; c++)
+						cellStart[grid.firstCell + r * grid.columns + c + 1]++;
+				}
+			}
+		}
+		for (unsigned i = 0; i < cellCount; i++)
+			cellStart[i + 1] += cellStart[i];
+
+		const unsigned entryCount = cellStart[cellCount];
+		minX.resize(entryCount);
+		minY.resize(entryCount);
+		maxX.resize(entryCount);
+		maxY.resize(entryCount);
+		entryLayers.resize(entryCount);
+		entryCandidates.resize(entryCount);
+		firstColumn.resize(entryCount);
+		firstRow.resize(entryCount);
+		cellCursor.assign(cellStart.begin(), cellStart.end() - 1);
+		for (unsigned g = 0; g < grids.size(); g++)
+		{
+			const Grid& grid = grids[g];
+			const unsigned extraCell = grid.firstCell + grid.columns * grid.rows;
+			for (unsigned i = grid.candidateBegin; i < grid.candidateEnd; i++)
+			{
+				const AABB bounds = orientedBoxes[i].getBounds();
+				const int c0 = column(grid, bounds.min.x), c1 = column(grid, bounds.max.x);
+				const int r0 = row(grid, bounds.min.y), r1 = row(grid, bounds.max.y);
+				const bool spansMany = (c1 - c0 + 1) * (r1 - r0 + 1) > GINES_QUERY_BATCH_MAX_SPAN;
+				for (int r = r0; r <= r1; r++)
+				{
+					for (int c = c0; c <= c1; c++)
+					{
+						const unsigned e = cellCursor[spansMany ? extraCell : grid.firstCell + r * grid.columns + c]++;
+						minX[e] = bounds.min.x;
+						minY[e] = bounds.min.y;
+						maxX[e] = bounds.max.x;
+						maxY[e] = bounds.max.y;
+						entryLayers[e] = candidates[i]->getLayers();
+						entryCandidates[e] = i;
+						firstColumn[e] = c0;
+						firstRow[e] = r0;
+						if (spansMany)
+							break;
+					}
+					if (spansMany)
+						break;
+				}
+			}
+		}
+	}
+
+	void QueryBatch::runRange(unsigned begin, unsigned end, RangeResults& range)
+	{
+		range.entries.clear();
+		range.fractions.clear();
+		for (unsigned i = begin; i < end; i++)
+		{
+			const unsigned before = range.entries.size();
+			if (kinds[i] == Point)
+				queryPoint(i, range);
+			else if (kinds[i] == Rect)
+				queryRect(i, range);
+			else
+				queryRay(i, range);
+			resultStart[i + 1] = range.entries.size() - before;
+		}
+	}
+	void QueryBatch::queryPoint(unsigned query, RangeResults& range)
+	{
+		const glm::vec2 point = a[query];
+		const Grid& grid = grids[queryGrids[query]];
+		const unsigned extraCell = grid.firstCell + grid.columns * grid.rows;
+		const unsigned cell = grid.firstCell + row(grid, point.y) * grid.columns + column(grid, point.x);
+		testPoint(cellStart[cell], cellStart[cell + 1], point, layerBits[query], range);
+		testPoint(cellStart[extraCell], cellStart[extraCell + 1], point, layerBits[query], range);
+	}
+	void QueryBatch::queryRect(unsigned query, RangeResults& range)
+	{
+		const AABB rect(a[query], b[query]);
+		const Grid& grid = grids[queryGrids[query]];
+		const unsigned extraCell = grid.firstCell + grid.columns * grid.rows;
+		const int c0 = column(grid, rect.min.x), c1 = column(grid, rect.max.x);
+		const int r0 = row(grid, rect.min.y), r1 = row(grid, rect.max.y);
+		for (int r = r0; r <= r1; r++)
+		{
+			for (int c = c0; c <= c1; c++)
+			{
+				const unsigned cell = grid.firstCell + r * grid.columns + c;
+				testRect(cellStart[cell], cellStart[cell + 1], rect, layerBits[query], c, r, c0, r0, range);
+			}
+		}
+		//Boxes in the extra cell are only in it once
+		testRect(cellStart[extraCell], cellStart[extraCell + 1], rect, layerBits[query], -1, -1, c0, r0, range);
+	}
+	void QueryBatch::queryRay(unsigned query, RangeResults& range)
+	{
+		const glm::vec2 from = a[query];
+		const glm::vec2 to = b[query];
+		const unsigned layers = layerBits[query];
+		const Grid& grid = grids[queryGrids[query]];
+		const unsigned extraCell = grid.firstCell + grid.columns * grid.rows;
+		const float deltaX = to.x - from.x;
+		const float deltaY = to.y - from.y;
+		const float lowY = from.y < to.y ? from.y : to.y;
+		const float highY = from.y > to.y ? from.y : to.y;
+		const float cellHeight = grid.inverseCellHeight > 0.0f ? 1.0f / grid.inverseCellHeight : 0.0f;
+
+		//Each row the segment crosses, over the columns that the part of the segment inside the row spans
+		range.hits.clear();
+		const int r0 = row(grid, lowY), r1 = row(grid, highY);
+		for (int r = r0; r <= r1; r++)
+		{
+			float bandLow = grid.area.min.y + float(r) * cellHeight - QUERY_BATCH_BAND_MARGIN * cellHeight;
+			float bandHigh = grid.area.min.y + float(r + 1) * cellHeight + QUERY_BATCH_BAND_MARGIN * cellHeight;
+			bandLow = bandLow > lowY ? bandLow : lowY;
+			bandHigh = bandHigh < highY ? bandHigh : highY;
+			float lowX, highX;
+			if (deltaY != 0.0f)
+			{
+				const float x1 = from.x + (bandLow - from.y) * deltaX / deltaY;
+				const float x2 = from.x + (bandHigh - from.y) * deltaX / deltaY;
+				lowX = x1 < x2 ? x1 : x2;
+				highX = x1 > x2 ? x1 : x2;
+			}
+			else
+			{
+				lowX = from.x < to.x ? from.x : to.x;
+				highX = from.x > to.x ? from.x : to.x;
+			}
+			//One extra column on each side covers rounding at the column edges
+			const int c0 = column(grid, lowX) > 0 ? column(grid, lowX) - 1 : 0;
+			const int c1 = column(grid, highX) < grid.columns - 1 ? column(grid, highX) + 1 : grid.columns - 1;
+			for (int c = c0; c <= c1; c++)
+			{
+				const unsigned cell = grid.firstCell + r * grid.columns + c;
+				testRay(cellStart[cell], cellStart[cell + 1], from, to, layers, range);
+			}
+		}
+		testRay(cellStart[extraCell], cellStart[extraCell + 1], from, to, layers, range);
+
+		//Copies of a box hit in several cells have the same fraction, so they end up next to each other
+		std::sort(range.hits.begin(), range.hits.end());
+		range.hits.erase(std::unique(range.hits.begin(), range.hits.end()), range.hits.end());
+		for (unsigned i = 0; i < range.hits.size(); i++)
+		{
+			range.entries.push_back(range.hits[i].second);
+			range.fractions.push_back(range.hits[i].first);
+		}
+	}
+
+	void QueryBatch::testPoint(unsigned begin, unsigned end, glm::vec2 point, unsigned layers, RangeResults& range)
+	{
+		unsigned e = begin;
+#ifdef GINES_SSE2
+		const __m128 pointX = _mm_set1_ps(point.x);
+		const __m128 pointY = _mm_set1_ps(point.y);
+		const __m128i layerMask = _mm_set1_epi32(int(layers));
+		const __m128i zeroBits = _mm_setzero_si128();
+		for (; e + 4 <= end; e += 4)
+		{
+			const __m128 inside = _mm_and_ps(
+				_mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(&minX[e]), pointX), _mm_cmpge_ps(_mm_loadu_ps(&maxX[e]), pointX)),
+				_mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(&minY[e]), pointY), _mm_cmpge_ps(_mm_loadu_ps(&maxY[e]), pointY)));
+			const __m128i blocked = _mm_cmpeq_epi32(_mm_and_si128(_mm_loadu_si128((const __m128i*)&entryLayers[e]), layerMask), zeroBits);
+			const int mask = _mm_movemask_ps(_mm_andnot_ps(_mm_castsi128_ps(blocked), inside));
+			for (int k = 0; mask != 0 && k < 4; k++)
+			{
+				const unsigned candidate = entryCandidates[e + k];
+				if ((mask & (1 << k)) && orientedBoxes[candidate].contains(point))
+				{
+					range.entries.push_back(candidate);
+					range.fractions.push_back(0.0f);
+				}
+			}
+		}
+#endif
+		for (; e < end; e++)
+		{
+			if ((entryLayers[e] & layers) == 0 || point.x < minX[e] || point.x > maxX[e] || point.y < minY[e] || point.y > maxY[e])
+				continue;
+			const unsigned candidate = entryCandidates[e];
+			if (orientedBoxes[candidate].contains(point))
+			{
+				range.entries.push_back(candidate);
+				range.fractions.push_back(0.0f);
+			}
+		}
+	}
+	void QueryBatch::testRect(unsigned begin, unsigned end, const AABB& rect, unsigned layers, int cellColumn, int cellRow, int rectColumn, int rectRow, RangeResults& range)
+	{
+		unsigned e = begin;
+#ifdef GINES_SSE2
+		const __m128 rectMinX = _mm_set1_ps(rect.min.x);
+		const __m128 rectMinY = _mm_set1_ps(rect.min.y);
+		const __m128 rectMaxX = _mm_set1_ps(rect.max.x);
+		const __m128 rectMaxY = _mm_set1_ps(rect.max.y);
+		const __m128i layerMask = _mm_set1_epi32(int(layers));
+		const __m128i zeroBits = _mm_setzero_si128();
+		for (; e + 4 <= end; e += 4)
+		{
+			const __m128 overlap = _mm_and_ps(
+				_mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(&minX[e]), rectMaxX), _mm_cmpge_ps(_mm_loadu_ps(&maxX[e]), rectMinX)),
+				_mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(&minY[e]), rectMaxY), _mm_cmpge_ps(_mm_loadu_ps(&maxY[e]), rectMinY)));
+			const __m128i blocked = _mm_cmpeq_epi32(_mm_and_si128(_mm_loadu_si128((const __m128i*)&entryLayers[e]), layerMask), zeroBits);
+			const int mask = _mm_movemask_ps(_mm_andnot_ps(_mm_castsi128_ps(blocked), overlap));
+			for (int k = 0; mask != 0 && k < 4; k++)
+			{
+				if ((mask & (1 << k)) == 0)
+					continue;
+				//A box in several cells is reported from the first cell it shares with the rect
+				const int firstSharedColumn = firstColumn[e + k] > rectColumn ? firstColumn[e + k] : rectColumn;
+				const int firstSharedRow = firstRow[e + k] > rectRow ? firstRow[e + k] : rectRow;
+				if (cellColumn >= 0 && (firstSharedColumn != cellColumn || firstSharedRow != cellRow))
+					continue;
+				range.entries.push_back(entryCandidates[e + k]);
+				range.fractions.push_back(0.0f);
+			}
+		}
+#endif
+		for (; e < end; e++)
+		{
+			if ((entryLayers[e] & layers) == 0 || maxX[e] < rect.min.x || minX[e] > rect.max.x || maxY[e] < rect.min.y || minY[e] > rect.max.y)
+				continue;
+			const int firstSharedColumn = firstColumn[e] > rectColumn ? firstColumn[e] : rectColumn;
+			const int firstSharedRow = firstRow[e] > rectRow ? firstRow[e] : rectRow;
+			if (cellColumn >= 0 && (firstSharedColumn != cellColumn || firstSharedRow != cellRow))
+				continue;
+			range.entries.push_back(entryCandidates[e]);
+			range.fractions.push_back(0.0f);
+		}
+	}
+	void QueryBatch::testRay(unsigned begin, unsigned end, glm::vec2 from, glm::vec2 to, unsigned layers, RangeResults& range)
+	{
+		unsigned e = begin;
+#ifdef GINES_SSE2
+		//Same slab test as AABB::intersectsSegment, four boxes at a time
+		const float deltaX = to.x - from.x;
+		const float deltaY = to.y - from.y;
+		const __m128 fromX = _mm_set1_ps(from.x);
+		const __m128 fromY = _mm_set1_ps(from.y);
+		const __m128 vDeltaX = _mm_set1_ps(deltaX);
+		const __m128 vDeltaY = _mm_set1_ps(deltaY);
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128i layerMask = _mm_set1_epi32(int(layers));
+		const __m128i zeroBits = _mm_setzero_si128();
+		float enterLanes[4];
+		for (; e + 4 <= end; e += 4)
+		{
+			const __m128 lowX = _mm_loadu_ps(&minX[e]);
+			const __m128 highX = _mm_loadu_ps(&maxX[e]);
+			const __m128 lowY = _mm_loadu_ps(&minY[e]);
+			const __m128 highY = _mm_loadu_ps(&maxY[e]);
+			__m128 enter = zero;
+			__m128 exit = one;
+			__m128 hit = _mm_cmpeq_ps(zero, zero);
+			if (deltaX == 0.0f)
+				hit = _mm_and_ps(hit, _mm_and_ps(_mm_cmpge_ps(fromX, lowX), _mm_cmple_ps(fromX, highX)));
+			else
+			{
+				const __m128 t1 = _mm_div_ps(_mm_sub_ps(lowX, fromX), vDeltaX);
+				const __m128 t2 = _mm_div_ps(_mm_sub_ps(highX, fromX), vDeltaX);
+				enter = _mm_max_ps(enter, _mm_min_ps(t1, t2));
+				exit = _mm_min_ps(exit, _mm_max_ps(t1, t2));
+			}
+			if (deltaY == 0.0f)
+				hit = _mm_and_ps(hit, _mm_and_ps(_mm_cmpge_ps(fromY, lowY), _mm_cmple_ps(fromY, highY)));
+			else
+			{
+				const __m128 t1 = _mm_div_ps(_mm_sub_ps(lowY, fromY), vDeltaY);
+				const __m128 t2 = _mm_div_ps(_mm_sub_ps(highY, fromY), vDeltaY);
+				enter = _mm_max_ps(enter, _mm_min_ps(t1, t2));
+				exit = _mm_min_ps(exit, _mm_max_ps(t1, t2));
+			}
+			hit = _mm_and_ps(hit, _mm_cmple_ps(enter, exit));
+			const __m128i blocked = _mm_cmpeq_epi32(_mm_and_si128(_mm_loadu_si128((const __m128i*)&entryLayers[e]), layerMask), zeroBits);
+			const int mask = _mm_movemask_ps(_mm_andnot_ps(_mm_castsi128_ps(blocked), hit));
+			if (mask == 0)
+				continue;
+			_mm_storeu_ps(enterLanes, enter);
+			for (int k = 0; k < 4; k++)
+			{
+				if (mask & (1 << k))
+					range.hits.push_back(std::make_pair(enterLanes[k], entryCandidates[e + k]));
+			}
+		}
+#endif
+		for (; e < end; e++)
+		{
+			float fraction;
+			if ((entryLayers[e] & layers) != 0 && AABB(glm::vec2(minX[e], minY[e]), glm::vec2(maxX[e], maxY[e])).intersectsSegment(from, to, fraction))
+				range.hits.push_back(std::make_pair(fraction, entryCandidates[e]));
+		}
+	}
+}
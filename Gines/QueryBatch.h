@@ -0,0 +1,132 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <glm/vec2.hpp>
+#include "Broadphase.h"
+
+#define GINES_QUERY_BATCH_MAX_CELLS 16384	//Most grid cells a cluster bins its boxes into
+#define GINES_QUERY_BATCH_MAX_TILES 65536	//Most tiles used to find the clusters of queries
+#define GINES_QUERY_BATCH_MAX_SPAN 16		//Boxes spanning more cells than this are tested by every query instead
+
+/*
+Answers many point, rect and ray queries against the collision boxes in one go, for mouse picking and line of sight:
+
+	gines::QueryBatch batch;
+	for (auto agent : agents)
+		batch.addRay(agent->eye(), playerPosition, wallLayers);
+	batch.run();
+	for (unsigned i = 0; i < batch.getQueryCount(); i++)
+		if (batch.getResultCount(i) == 0) ...//Agent i sees the player
+
+run() splits the queries in halves until the queries of each cluster cover most of its area, measured on a coarse grid of
+tiles over all queries. It gets the boxes in the area of each cluster from the active broadphase once, copies their bounds
+into a grid per cluster, and answers the queries from that copy on the job system, four boxes at a time with SSE2.
+Queries far apart only copy the boxes around them, not the whole area between them.
+Like the broadphase queries, boxes moved earlier in the same frame are only seen after updateBroadphase().
+Point queries test the rotated boxes like CollisionBox::isColliding. Rects and rays test the bounds like
+Broadphase::queryRect and queryRay. Ray results are ordered nearest first.
+*/
+namespace gines
+{
+	class QueryBatch
+	{
+	public:
+		QueryBatch();
+		~QueryBatch();
+
+		//Queries only find boxes on at least one of the given layers. Each returns the index of the query
+		unsigned addPoint(glm::vec2 point, unsigned layers = GINES_ALL_LAYERS);
+		unsigned addRect(const AABB& rect, unsigned layers = GINES_ALL_LAYERS);
+		unsigned addRay(glm::vec2 from, glm::vec2 to, unsigned layers = GINES_ALL_LAYERS);
+		void clear();//Removes the queries and their results, keeps the memory for the next batch
+
+		void run(bool parallel = true);//Replaces the results of the previous run
+
+		//Results of every query are packed into one array, query i owns [getResultStart(i), getResultStart(i) + getResultCount(i))
+		unsigned getQueryCount(){ return kinds.size(); }
+		unsigned getResultStart(unsigned query){ return resultStart[query]; }
+		unsigned getResultCount(unsigned query){ return resultStart[query + 1] - resultStart[query]; }
+		CollisionBox* const* getBoxes(unsigned query){ return resultBoxes.data() + resultStart[query]; }
+		const float* getFractions(unsigned query){ return resultFractions.data() + resultStart[query]; }//See RayHit, 0 for points and rects
+		const std::vector<CollisionBox*>& getAllBoxes(){ return resultBoxes; }
+		const std::vector<float>& getAllFractions(){ return resultFractions; }
+
+	private:
+		QueryBatch(const QueryBatch&);
+		void operator=(const QueryBatch&);
+
+		enum Kind : unsigned char { Point, Rect, Ray };
+		//Results of one range of queries, in query order. Entries are indices into candidates
+		struct RangeResults
+		{
+			std::vector<unsigned> entries;
+			std::vector<float> fractions;
+			std::vector<std::pair<float, unsigned>> hits;//Ray hits before sorting, a box in several cells is hit in each
+		};
+
+		//Cell grid over the area of a cluster of queries
+		struct Grid
+		{
+			AABB area;//Of the queries in the cluster
+			unsigned layers;//Of the queries in the cluster
+			unsigned candidateBegin;//Candidates of the grid are at [candidateBegin, candidateEnd)
+			unsigned candidateEnd;
+			int columns;
+			int rows;
+			float inverseCellWidth;
+			float inverseCellHeight;
+			unsigned firstCell;//Cells of the grid are at [firstCell, firstCell + columns * rows], the last one holds the boxes that span too many cells
+		};
+
+		void buildClusters();
+		void buildGrids();
+		void runRange(unsigned begin, unsigned end, RangeResults& range);
+		void queryPoint(unsigned query, RangeResults& range);
+		void queryRect(unsigned query, RangeResults& range);
+		void queryRay(unsigned query, RangeResults& range);
+		//Test the entries of a cell
+		void testPoint(unsigned begin, unsigned end, glm::vec2 point, unsigned layers, RangeResults& range);
+		void testRect(unsigned begin, unsigned end, const AABB& rect, unsigned layers, int cellColumn, int cellRow, int rectColumn, int rectRow, RangeResults& range);
+		void testRay(unsigned begin, unsigned end, glm::vec2 from, glm::vec2 to, unsigned layers, RangeResults& range);
+		int column(const Grid& grid, float x);
+		int row(const Grid& grid, float y);
+
+		//Queries. Points use a, rects a as min and b as max, rays a as from and b as to
+		std::vector<unsigned char> kinds;
+		std::vector<glm::vec2> a;
+		std::vector<glm::vec2> b;
+		std::vector<unsigned> layerBits;
+
+		//Clusters
+		std::vector<unsigned> queryGrids;//Grid of each query
+		std::vector<int> tileCoverage;//Queries over each tile
+		std::vector<int> coveredTiles;
+		std::vector<unsigned> clusterQueries;
+		std::vector<std::pair<unsigned, unsigned>> clusterRanges;//Of clusterQueries left to split
+
+		//Boxes in the areas of the clusters, a box near several clusters is a candidate of each
+		std::vector<CollisionBox*> candidates;
+		std::vector<OrientedBox> orientedBoxes;//Of each candidate
+
+		//Cells of every grid. Entries of cell i are at [cellStart[i], cellStart[i + 1])
+		std::vector<Grid> grids;
+		std::vector<unsigned> cellStart;
+		std::vector<unsigned> cellCursor;
+		//Entries
+		std::vector<float> minX;
+		std::vector<float> minY;
+		std::vector<float> maxX;
+		std::vector<float> maxY;
+		std::vector<unsigned> entryLayers;
+		std::vector<unsigned> entryCandidates;
+		std::vector<int> firstColumn;//First cell of the box, so that rect queries report boxes in several cells once
+		std::vector<int> firstRow;
+
+		//Results
+		std::vector<unsigned> resultStart;
+		std::vector<CollisionBox*> resultBoxes;
+		std::vector<float> resultFractions;
+		std::vector<RangeResults> ranges;
+	};
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+/*
+SSE2 helpers for batch kernels. GINES_SSE2 is defined when the target always has SSE2
+(x64, /arch:SSE2 on x86 or -msse2), kernels must have a scalar path for other targets.
+*/
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define GINES_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#include <cmath>
+
+#define GINES_PI 3.14159265358979f
+#define GINES_TWO_PI 6.28318530717959f
+
+namespace gines
+{
+	namespace simd
+	{
+		//Wraps an angle to [0, 2pi) without looping
+		inline float wrapAngle(float angle)
+		{
+			float turns = angle * (1.0f / GINES_TWO_PI);
+			int whole = int(turns);
+			if (float(whole) > turns)
+				whole--;
+			float wrapped = angle - float(whole) * GINES_TWO_PI;
+			return wrapped >= GINES_TWO_PI ? 0.0f : wrapped;
+		}
+
+		/*Scalar versions of the SSE2 sine and cosine below, doing the same operations in the same order
+		so that the tail of a batch gets the same results as the rest*/
+		inline float floorFast(float x)
+		{
+			float truncated = float(int(x));
+			return truncated > x ? truncated - 1.0f : truncated;
+		}
+		inline float sinPiRange(float x)
+		{
+			float absX = std::fabs(x);
+			float folded = absX > GINES_PI * 0.5f ? GINES_PI - absX : absX;
+			float x2 = folded * folded;
+			float p = -2.5052108e-8f;
+			p = p * x2 + 2.7557319e-6f;
+			p = p * x2 + -1.9841270e-4f;
+			p = p * x2 + 8.3333333e-3f;
+			p = p * x2 + -1.6666667e-1f;
+			p = p * x2 + 1.0f;
+			float result = p * folded;
+			return std::signbit(x) ? -result : result;
+		}
+		inline void sinCos(float angle, float& sine, float& cosine)
+		{
+			float x = angle - floorFast((angle + GINES_PI) * (1.0f / GINES_TWO_PI)) * GINES_TWO_PI;
+			sine = sinPiRange(x);
+			float shifted = x + GINES_PI * 0.5f;
+			if (shifted >= GINES_PI)
+				shifted -= GINES_TWO_PI;
+			cosine = sinPiRange(shifted);
+		}
+
+#ifdef GINES_SSE2
+		//floor() for |x| < 2^31, SSE2 has no rounding instruction
+		inline __m128 floorPs(__m128 x)
+		{
+			__m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+			__m128 correction = _mm_and_ps(_mm_cmpgt_ps(truncated, x), _mm_set1_ps(1.0f));
+			return _mm_sub_ps(truncated, correction);
+		}
+
+		inline __m128 wrapAnglePs(__m128 angle)
+		{
+			__m128 turns = floorPs(_mm_mul_ps(angle, _mm_set1_ps(1.0f / GINES_TWO_PI)));
+			__m128 wrapped = _mm_sub_ps(angle, _mm_mul_ps(turns, _mm_set1_ps(GINES_TWO_PI)));
+			//Rounding can land exactly on 2pi
+			return _mm_andnot_ps(_mm_cmpge_ps(wrapped, _mm_set1_ps(GINES_TWO_PI)), wrapped);
+		}
+
+		//sin(x) for x in [-pi, pi). Folded to [-pi/2, pi/2] with sin(x) = sin(pi - x) and evaluated with a degree 11 polynomial
+		inline __m128 sinPiRangePs(__m128 x)
+		{
+			const __m128 signMask = _mm_set1_ps(-0.0f);
+			const __m128 halfPi = _mm_set1_ps(GINES_PI * 0.5f);
+			__m128 sign = _mm_and_ps(x, signMask);
+			__m128 absX = _mm_andnot_ps(signMask, x);
+			__m128 over = _mm_cmpgt_ps(absX, halfPi);
+			__m128 folded = _mm_or_ps(_mm_and_ps(over, _mm_sub_ps(_mm_set1_ps(GINES_PI), absX)), _mm_andnot_ps(over, absX));
+			__m128 x2 = _mm_mul_ps(folded, folded);
+			__m128 p = _mm_set1_ps(-2.5052108e-8f);
+			p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(2.7557319e-6f));
+			p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(-1.9841270e-4f));
+			p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(8.3333333e-3f));
+			p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(-1.6666667e-1f));
+			p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(1.0f));
+			return _mm_xor_ps(_mm_mul_ps(p, folded), sign);
+		}
+
+		//Sine and cosine of 4 angles, error stays below 1e-6 for angles within a few turns of zero
+		inline void sinCosPs(__m128 angle, __m128& sine, __m128& cosine)
+		{
+			const __m128 pi = _mm_set1_ps(GINES_PI);
+			const __m128 twoPi = _mm_set1_ps(GINES_TWO_PI);
+			//Bring to [-pi, pi)
+			__m128 x = _mm_sub_ps(angle, _mm_mul_ps(floorPs(_mm_mul_ps(_mm_add_ps(angle, pi), _mm_set1_ps(1.0f / GINES_TWO_PI))), twoPi));
+			sine = sinPiRangePs(x);
+			//cos(x) = sin(x + pi/2), wrapped back to [-pi, pi)
+			__m128 shifted = _mm_add_ps(x, _mm_set1_ps(GINES_PI * 0.5f));
+			shifted = _mm_sub_ps(shifted, _mm_and_ps(_mm_cmpge_ps(shifted, pi), twoPi));
+			cosine = sinPiRangePs(shifted);
+		}
+#endif
+	}
+}
@@ -0,0 +1,216 @@
+#include "SpatialHash.h"
+#include "CollisionBox.h"
+#include <climits>
+
+namespace gines
+{
+	SpatialHash::SpatialHash(float size) : cellSize(size), inverseCellSize(1.0f / size)
+	{
+	}
+	SpatialHash::~SpatialHash()
+	{
+		clear();
+	}
+
+	void SpatialHash::addToCells(unsigned proxy)
+	{
+		Proxy& p = proxies[proxy];
+		for (int x = p.minX; x <= p.maxX; x++)
+		{
+			for (int y = p.minY; y <= p.maxY; y++)
+			{
+				cells[cellKey(x, y)].push_back(proxy);
+			}
+		}
+	}
+	void SpatialHash::removeFromCells(unsigned proxy)
+	{
+		Proxy& p = proxies[proxy];
+		for (int x = p.minX; x <= p.maxX; x++)
+		{
+			for (int y = p.minY; y <= p.maxY; y++)
+			{
+				auto it = cells.find(cellKey(x, y));
+				if (it == cells.end())
+					continue;
+				std::vector<unsigned>& cell = it->second;
+				for (unsigned i = 0; i < cell.size(); i++)
+				{
+					if (cell[i] == proxy)
+					{
+						cell[i] = cell.back();
+						cell.pop_back();
+						break;
+					}
+				}
+				if (cell.empty())
+					cells.erase(it);
+			}
+		}
+	}
+
+	void SpatialHash::insert(CollisionBox* box)
+	{
+		unsigned proxy;
+		if (freeProxies.empty())
+		{
+			proxy = proxies.size();
+			proxies.push_back(Proxy());
+		}
+		else
+		{
+			proxy = freeProxies.back();
+			freeProxies.pop_back();
+		}
+		Proxy& p = proxies[proxy];
+		p.box = box;
+		p.bounds = box->getBounds();
+		p.layers = box->getLayers();
+		p.mask = box->getMask();
+		p.minX = cellCoordinate(p.bounds.min.x);
+		p.minY = cellCoordinate(p.bounds.min.y);
+		p.maxX = cellCoordinate(p.bounds.max.x);
+		p.maxY = cellCoordinate(p.bounds.max.y);
+		p.queryStamp = 0;
+		box->setProxy(proxy);
+		addToCells(proxy);
+	}
+	void SpatialHash::remove(CollisionBox* box)
+	{
+		unsigned proxy = box->getProxy();
+		if (proxy >= proxies.size() || proxies[proxy].box != box)
+			return;
+		removeFromCells(proxy);
+		proxies[proxy].box = nullptr;
+		freeProxies.push_back(proxy);
+		box->setProxy(UINT_MAX);
+	}
+	void SpatialHash::update(CollisionBox* box)
+	{
+		unsigned proxy = box->getProxy();
+		if (proxy >= proxies.size() || proxies[proxy].box != box)
+			return;
+		Proxy& p = proxies[proxy];
+		p.bounds = box->getBounds();
+		p.layers = box->getLayers();
+		p.mask = box->getMask();
+		int minX = cellCoordinate(p.bounds.min.x);
+		int minY = cellCoordinate(p.bounds.min.y);
+		int maxX = cellCoordinate(p.bounds.max.x);
+		int maxY = cellCoordinate(p.bounds.max.y);
+		if (minX == p.minX && minY == p.minY && maxX == p.maxX && maxY == p.maxY)
+			return;//Still in the same cells
+		removeFromCells(proxy);
+		p.minX = minX;
+		p.minY = minY;
+		p.maxX = maxX;
+		p.maxY = maxY;
+		addToCells(proxy);
+	}
+	void SpatialHash::clear()
+	{
+		for (unsigned i = 0; i < proxies.size(); i++)
+		{
+			if (proxies[i].box != nullptr)
+				proxies[i].box->setProxy(UINT_MAX);
+		}
+		proxies.clear();
+		freeProxies.clear();
+		cells.clear();
+	}
+	void SpatialHash::setCellSize(float size)
+	{
+		cellSize = size;
+		inverseCellSize = 1.0f / size;
+		cells.clear();
+		for (unsigned i = 0; i < proxies.size(); i++)
+		{
+			Proxy& p = proxies[i];
+			if (p.box == nullptr)
+				continue;
+			p.minX = cellCoordinate(p.bounds.min.x);
+			p.minY = cellCoordinate(p.bounds.min.y);
+			p.maxX = cellCoordinate(p.bounds.max.x);
+			p.maxY = cellCoordinate(p.bounds.max.y);
+			addToCells(i);
+		}
+	}
+
+	void SpatialHash::queryPairs(std::vector<CollisionPair>& pairs)
+	{
+		for (auto it = cells.begin(); it != cells.end(); it++)
+		{
+			const std::vector<unsigned>& cell = it->second;
+			if (cell.size() < 2)
+				continue;
+			const int cellX = int(int32_t(it->first >> 32));
+			const int cellY = int(int32_t(it->first & 0xffffffff));
+			for (unsigned i = 0; i < cell.size(); i++)
+			{
+				const Proxy& a = proxies[cell[i]];
+				for (unsigned j = i + 1; j < cell.size(); j++)
+				{
+					const Proxy& b = proxies[cell[j]];
+					//Boxes sharing several cells are reported only from the first shared cell
+					if ((a.minX > b.minX ? a.minX : b.minX) != cellX || (a.minY > b.minY ? a.minY : b.minY) != cellY)
+						continue;
+					if (Broadphase::canCollide(a.layers, a.mask, b.layers, b.mask) && a.bounds.overlaps(b.bounds))
+						pairs.push_back(CollisionPair(a.box, b.box));
+				}
+			}
+		}
+	}
+	void SpatialHash::queryRect(const AABB& rect, std::vector<CollisionBox*>& results, unsigned layers)
+	{
+		const int minX = cellCoordinate(rect.min.x);
+		const int minY = cellCoordinate(rect.min.y);
+		const int maxX = cellCoordinate(rect.max.x);
+		const int maxY = cellCoordinate(rect.max.y);
+		const int64_t columns = int64_t(maxX) - minX + 1;
+		const int64_t rows = int64_t(maxY) - minY + 1;
+		const int64_t proxyCount = proxies.size();
+		if (columns > proxyCount || rows > proxyCount || columns * rows > proxyCount)
+		{//Cheaper to test every box than to look up every cell
+			for (unsigned i = 0; i < proxies.size(); i++)
+			{
+				const Proxy& p = proxies[i];
+				if (p.box != nullptr && (p.layers & layers) != 0 && p.bounds.overlaps(rect))
+					results.push_back(p.box);
+			}
+			return;
+		}
+		queryStamp++;
+		for (int x = minX; x <= maxX; x++)
+		{
+			for (int y = minY; y <= maxY; y++)
+			{
+				auto it = cells.find(cellKey(x, y));
+				if (it == cells.end())
+					continue;
+				const std::vector<unsigned>& cell = it->second;
+				for (unsigned i = 0; i < cell.size(); i++)
+				{
+					Proxy& p = proxies[cell[i]];
+					if (p.queryStamp == queryStamp)
+						continue;
+					p.queryStamp = queryStamp;
+					if ((p.layers & layers) != 0 && p.bounds.overlaps(rect))
+						results.push_back(p.box);
+				}
+			}
+		}
+	}
+	void SpatialHash::queryPoint(glm::vec2 point, std::vector<CollisionBox*>& results, unsigned layers)
+	{
+		auto it = cells.find(cellKey(cellCoordinate(point.x), cellCoordinate(point.y)));
+		if (it == cells.end())
+			return;
+		const std::vector<unsigned>& cell = it->second;
+		for (unsigned i = 0; i < cell.size(); i++)
+		{
+			const Proxy& p = proxies[cell[i]];
+			if ((p.layers & layers) != 0 && p.bounds.contains(point))
+				results.push_back(p.box);
+		}
+	}
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cmath>
+#include "Broadphase.h"
+
+#define GINES_SPATIAL_HASH_CELL_SIZE 64.0f	//Default cell size in world units
+
+namespace gines
+{
+	/*Uniform grid broadphase. Cells are only allocated where there are boxes.
+	Works best when most boxes are smaller than a cell, a box spanning many cells is stored in each of them.
+	Rects covering more cells than there are boxes are answered by testing every box*/
+	class SpatialHash : public Broadphase
+	{
+	public:
+		SpatialHash(float cellSize = GINES_SPATIAL_HASH_CELL_SIZE);
+		~SpatialHash();
+
+		void insert(CollisionBox* box);
+		void remove(CollisionBox* box);
+		void update(CollisionBox* box);
+		void clear();
+
+		void queryPairs(std::vector<CollisionPair>& pairs);
+		void queryRect(const AABB& rect, std::vector<CollisionBox*>& results, unsigned layers = GINES_ALL_LAYERS);
+		void queryPoint(glm::vec2 point, std::vector<CollisionBox*>& results, unsigned layers = GINES_ALL_LAYERS);
+
+		void setCellSize(float size);//Rebuilds the grid
+		float getCellSize(){ return cellSize; }
+		unsigned getCellCount(){ return cells.size(); }
+
+	private:
+		struct Proxy
+		{
+			CollisionBox* box;//nullptr when the proxy is free
+			AABB bounds;
+			unsigned layers;//Copied from the box
+			unsigned mask;
+			int minX, minY, maxX, maxY;//Cell range
+			unsigned queryStamp;//Used to report a box only once per query
+		};
+		int cellCoordinate(float value){ return int(std::floor(value * inverseCellSize)); }
+		static uint64_t cellKey(int x, int y){ return (uint64_t(uint32_t(x)) << 32) | uint32_t(y); }
+		void addToCells(unsigned proxy);
+		void removeFromCells(unsigned proxy);
+
+		float cellSize;
+		float inverseCellSize;
+		std::vector<Proxy> proxies;
+		std::vector<unsigned> freeProxies;
+		std::unordered_map<uint64_t, std::vector<unsigned>> cells;//Proxies in each cell
+		unsigned queryStamp = 0;
+	};
+}
@@ -5,14 +5,22 @@
 #include "GLSLProgram.h"
 #include "GameObject.h"
 #include "Geometry.h"
+#include "Profiler.h"
 
 namespace gines
 {
 	extern GLSLProgram colorProgram;
 	
-	Sprite::Sprite() : position(0, 0), origin(0, 0), rotation(0), width(0), height(0), doBufferUpdate(true)
+	Sprite::Sprite() : position(0, 0), origin(0, 0), rotation(0), width(0), height(0), vboID(0), doBufferUpdate(true), transformVersion(0)
 	{
 	}
+	Sprite::Sprite(const Sprite& original) : Component(original), useCamerasVectorForRendering(original.useCamerasVectorForRendering),
+		position(original.position), origin(original.origin), rotation(original.rotation), width(original.width), height(original.height),
+		vboID(0), tex(original.tex), doBufferUpdate(true), transformVersion(0)
+	{
+		if (original.vboID != 0)
+			glGenBuffers(1, &vboID);
+	}
 
 
 	Sprite::~Sprite()
@@ -90,8 +98,8 @@ namespace gines
 		float worldRot = rotation;
 		if (gameObject != nullptr)
 		{
-			worldPos += gameObject->transform().getPosition();
-			worldRot += gameObject->transform().getRotation();
+			worldPos += gameObject->transform().getWorldPosition();
+			worldRot += gameObject->transform().getWorldRotation();
 		}
 
 		//Corner positions in world space
@@ -139,6 +147,7 @@ namespace gines
 
 		glBindBuffer(GL_ARRAY_BUFFER, vboID);
 		glBufferData(GL_ARRAY_BUFFER, sizeof(vertexData), vertexData, GL_STATIC_DRAW);
+		perfCounters.bufferBytes += sizeof(vertexData);
 
 		glBindBuffer(GL_ARRAY_BUFFER, 0);
 
@@ -182,14 +191,10 @@ namespace gines
 		cam->enableViewport();
 		if (gameObject != nullptr)
 		{
-			if (gameObjectPosition != gameObject->transform().getPosition())
-			{//Game object has moved
-				gameObjectPosition = gameObject->transform().getPosition();
-				doBufferUpdate = true;
-			}
-			if (gameObjectRotation != gameObject->transform().getRotation())
-			{//Game object has rotated
-				gameObjectRotation = gameObject->transform().getRotation();
+			unsigned version = gameObject->transform().getWorldVersion();
+			if (transformVersion != version)
+			{//Game object or one of its parents has moved
+				transformVersion = version;
 				doBufferUpdate = true;
 			}
 		}
@@ -221,6 +226,9 @@ namespace gines
 		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(VertexPositionColorTexture), (void*)offsetof(VertexPositionColorTexture, uv));
 
 		glDrawArrays(GL_TRIANGLES, 0, 6);
+		perfCounters.drawCalls++;
+		perfCounters.textureBinds++;
+		perfCounters.sprites++;
 
 
 		glDisableVertexAttribArray(0);
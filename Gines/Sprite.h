@@ -7,10 +7,6 @@
 #include "Vertex.h"
 #include "Component.h"
 
-struct AABB {
-
-};
-
 namespace gines
 {
 	class Camera;
@@ -18,10 +14,12 @@ namespace gines
 	{
 	public:
 		Sprite();
+		Sprite(const Sprite& original);//The copy gets its own vertex buffer
 		~Sprite();
 
 	void initialize(glm::vec2 pos, int w, int h, std::string path);
 		void render();
+		bool isThreadSafe(){ return true; }//No update
 		void setPosition(glm::vec2& newPosition);
 		void setPosition(float _x, float _y);
 		void setRotation(float newRotation);
@@ -44,8 +42,7 @@ namespace gines
 		//Game object tracking
 		void updateBuffer();
 		bool doBufferUpdate;
-		glm::vec2 gameObjectPosition;	//Previous position of game object
-		float gameObjectRotation;		//Previous rotation of game object
+		unsigned transformVersion;	//World transform version of the game object that the buffer was built with
 
 	};
 }
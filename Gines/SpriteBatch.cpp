@@ -1,4 +1,5 @@
 #include "SpriteBatch.h"
+#include "Profiler.h"
 
 #include <algorithm>
 
@@ -87,7 +88,10 @@ namespace gines
 			glBindTexture(GL_TEXTURE_2D, batches[i].texture);
 			
 			glDrawArrays(GL_TRIANGLES, batches[i].offset, batches[i].verticeAmount);
+			perfCounters.sprites += batches[i].verticeAmount / 6;
 		}
+		perfCounters.drawCalls += batches.size();
+		perfCounters.textureBinds += batches.size();
 
 		glDisableVertexAttribArray(0);
 		glDisableVertexAttribArray(1);
@@ -143,6 +147,7 @@ namespace gines
 		glBindBuffer(GL_ARRAY_BUFFER, vbo);
 		glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(VertexPositionColorTexture), nullptr, GL_DYNAMIC_DRAW); // Orphan the buffer.
 		glBufferSubData(GL_ARRAY_BUFFER, 0, vertices.size() * sizeof(VertexPositionColorTexture), vertices.data()); // Upload data.
+		perfCounters.bufferBytes += vertices.size() * sizeof(VertexPositionColorTexture);
 
 		glBindBuffer(GL_ARRAY_BUFFER, 0);
 		
@@ -0,0 +1,264 @@
+#include "SweepAndPrune.h"
+#include "CollisionBox.h"
+#include "Simd.h"
+#include <algorithm>
+#include <climits>
+
+#define SAP_FULL_SORT_THRESHOLD 64	//Unsorted insertions after which a full sort is cheaper than insertion sort
+
+namespace gines
+{
+	SweepAndPrune::SweepAndPrune()
+	{
+	}
+	SweepAndPrune::~SweepAndPrune()
+	{
+		clear();
+	}
+
+	void SweepAndPrune::insert(CollisionBox* box)
+	{
+		unsigned id;
+		if (freeIds.empty())
+		{
+			id = dense.size();
+			dense.push_back(0);
+		}
+		else
+		{
+			id = freeIds.back();
+			freeIds.pop_back();
+		}
+		AABB bounds = box->getBounds();
+		dense[id] = boxes.size();
+		minX.push_back(bounds.min.x);
+		minY.push_back(bounds.min.y);
+		maxX.push_back(bounds.max.x);
+		maxY.push_back(bounds.max.y);
+		layerBits.push_back(box->getLayers());
+		maskBits.push_back(box->getMask());
+		boxes.push_back(box);
+		ids.push_back(id);
+		box->setProxy(id);
+		insertedCount++;
+		sorted = false;
+	}
+	void SweepAndPrune::remove(CollisionBox* box)
+	{
+		unsigned id = box->getProxy();
+		if (id >= dense.size() || dense[id] == UINT_MAX || boxes[dense[id]] != box)
+			return;
+		//The entry is dropped on the next query
+		boxes[dense[id]] = nullptr;
+		dense[id] = UINT_MAX;
+		freeIds.push_back(id);
+		box->setProxy(UINT_MAX);
+		removedCount++;
+	}
+	void SweepAndPrune::update(CollisionBox* box)
+	{
+		unsigned id = box->getProxy();
+		if (id >= dense.size() || dense[id] == UINT_MAX || boxes[dense[id]] != box)
+			return;
+		unsigned i = dense[id];
+		AABB bounds = box->getBounds();
+		minX[i] = bounds.min.x;
+		minY[i] = bounds.min.y;
+		maxX[i] = bounds.max.x;
+		maxY[i] = bounds.max.y;
+		layerBits[i] = box->getLayers();
+		maskBits[i] = box->getMask();
+		sorted = false;
+	}
+	void SweepAndPrune::clear()
+	{
+		for (unsigned i = 0; i < boxes.size(); i++)
+		{
+			if (boxes[i] != nullptr)
+				boxes[i]->setProxy(UINT_MAX);
+		}
+		minX.clear();
+		minY.clear();
+		maxX.clear();
+		maxY.clear();
+		layerBits.clear();
+		maskBits.clear();
+		boxes.clear();
+		ids.clear();
+		dense.clear();
+		freeIds.clear();
+		removedCount = 0;
+		insertedCount = 0;
+		sorted = true;
+	}
+
+	void SweepAndPrune::prepare()
+	{
+		if (removedCount > 0)
+		{//Compact, keeping the order
+			unsigned write = 0;
+			for (unsigned read = 0; read < boxes.size(); read++)
+			{
+				if (boxes[read] == nullptr)
+					continue;
+				minX[write] = minX[read];
+				minY[write] = minY[read];
+				maxX[write] = maxX[read];
+				maxY[write] = maxY[read];
+				layerBits[write] = layerBits[read];
+				maskBits[write] = maskBits[read];
+				boxes[write] = boxes[read];
+				ids[write] = ids[read];
+				dense[ids[write]] = write;
+				write++;
+			}
+			minX.resize(write);
+			minY.resize(write);
+			maxX.resize(write);
+			maxY.resize(write);
+			layerBits.resize(write);
+			maskBits.resize(write);
+			boxes.resize(write);
+			ids.resize(write);
+			removedCount = 0;
+		}
+		if (!sorted)
+			sort();
+	}
+	void SweepAndPrune::swapEntries(unsigned a, unsigned b)
+	{
+		std::swap(minX[a], minX[b]);
+		std::swap(minY[a], minY[b]);
+		std::swap(maxX[a], maxX[b]);
+		std::swap(maxY[a], maxY[b]);
+		std::swap(layerBits[a], layerBits[b]);
+		std::swap(maskBits[a], maskBits[b]);
+		std::swap(boxes[a], boxes[b]);
+		std::swap(ids[a], ids[b]);
+		dense[ids[a]] = a;
+		dense[ids[b]] = b;
+	}
+	void SweepAndPrune::sort()
+	{
+		const unsigned count = minX.size();
+		if (insertedCount > SAP_FULL_SORT_THRESHOLD)
+		{//Many new entries in arbitrary order, sort an index list and gather
+			std::vector<unsigned> order(count);
+			for (unsigned i = 0; i < count; i++)
+				order[i] = i;
+			const std::vector<float>& keys = minX;
+			std::sort(order.begin(), order.end(), [&keys](unsigned a, unsigned b){ return keys[a] < keys[b]; });
+			std::vector<float> sortedMinX(count), sortedMinY(count), sortedMaxX(count), sortedMaxY(count);
+			std::vector<unsigned> sortedLayers(count), sortedMasks(count);
+			std::vector<CollisionBox*> sortedBoxes(count);
+			std::vector<unsigned> sortedIds(count);
+			for (unsigned i = 0; i < count; i++)
+			{
+				unsigned from = order[i];
+				sortedMinX[i] = minX[from];
+				sortedMinY[i] = minY[from];
+				sortedMaxX[i] = maxX[from];
+				sortedMaxY[i] = maxY[from];
+				sortedLayers[i] = layerBits[from];
+				sortedMasks[i] = maskBits[from];
+				sortedBoxes[i] = boxes[from];
+				sortedIds[i] = ids[from];
+				dense[sortedIds[i]] = i;
+			}
+			minX.swap(sortedMinX);
+			minY.swap(sortedMinY);
+			maxX.swap(sortedMaxX);
+			maxY.swap(sortedMaxY);
+			layerBits.swap(sortedLayers);
+			maskBits.swap(sortedMasks);
+			boxes.swap(sortedBoxes);
+			ids.swap(sortedIds);
+		}
+		else
+		{//Boxes move little between frames, so entries are close to their sorted place
+			for (unsigned i = 1; i < count; i++)
+			{
+				for (unsigned j = i; j > 0 && minX[j - 1] > minX[j]; j--)
+					swapEntries(j - 1, j);
+			}
+		}
+		insertedCount = 0;
+		sorted = true;
+	}
+	unsigned SweepAndPrune::findEnd(float x)
+	{
+		return std::upper_bound(minX.begin(), minX.end(), x) - minX.begin();
+	}
+
+	void SweepAndPrune::queryPairs(std::vector<CollisionPair>& pairs)
+	{
+		prepare();
+		const unsigned count = minX.size();
+		for (unsigned i = 0; i < count; i++)
+		{
+			//Entries after i start at or after minX[i], so only their start needs to be tested against maxX[i]
+			const float endX = maxX[i];
+			const float startY = minY[i];
+			const float endY = maxY[i];
+			const unsigned layersI = layerBits[i];
+			const unsigned maskI = maskBits[i];
+			unsigned j = i + 1;
+#ifdef GINES_SSE2
+			const __m128 vEndX = _mm_set1_ps(endX);
+			const __m128 vStartY = _mm_set1_ps(startY);
+			const __m128 vEndY = _mm_set1_ps(endY);
+			const __m128i vLayers = _mm_set1_epi32(int(layersI));
+			const __m128i vMask = _mm_set1_epi32(int(maskI));
+			const __m128i zeroBits = _mm_setzero_si128();
+			bool passedEnd = false;
+			for (; j + 4 <= count; j += 4)
+			{
+				const __m128 inX = _mm_cmple_ps(_mm_loadu_ps(&minX[j]), vEndX);
+				const int maskX = _mm_movemask_ps(inX);
+				if (maskX == 0)
+				{
+					passedEnd = true;
+					break;
+				}
+				const __m128 inY = _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(&minY[j]), vEndY), _mm_cmpge_ps(_mm_loadu_ps(&maxY[j]), vStartY));
+				//Lanes where either layer test comes out empty
+				const __m128i blocked = _mm_or_si128(
+					_mm_cmpeq_epi32(_mm_and_si128(_mm_loadu_si128((const __m128i*)&layerBits[j]), vMask), zeroBits),
+					_mm_cmpeq_epi32(_mm_and_si128(_mm_loadu_si128((const __m128i*)&maskBits[j]), vLayers), zeroBits));
+				const int mask = _mm_movemask_ps(_mm_andnot_ps(_mm_castsi128_ps(blocked), _mm_and_ps(inX, inY)));
+				for (int k = 0; k < 4; k++)
+				{
+					if (mask & (1 << k))
+						pairs.push_back(CollisionPair(boxes[i], boxes[j + k]));
+				}
+				if (maskX != 0xf)
+				{
+					passedEnd = true;
+					break;
+				}
+			}
+			if (passedEnd)
+				continue;
+#endif
+			for (; j < count && minX[j] <= endX; j++)
+			{
+				if (minY[j] <= endY && maxY[j] >= startY && Broadphase::canCollide(layersI, maskI, layerBits[j], maskBits[j]))
+					pairs.push_back(CollisionPair(boxes[i], boxes[j]));
+			}
+		}
+	}
+	void SweepAndPrune::queryRect(const AABB& rect, std::vector<CollisionBox*>& results, unsigned layers)
+	{
+		prepare();
+		const unsigned end = findEnd(rect.max.x);
+		for (unsigned i = 0; i < end; i++)
+		{
+			if ((layerBits[i] & layers) != 0 && maxX[i] >= rect.min.x && minY[i] <= rect.max.y && maxY[i] >= rect.min.y)
+				results.push_back(boxes[i]);
+		}
+	}
+	void SweepAndPrune::queryPoint(glm::vec2 point, std::vector<CollisionBox*>& results, unsigned layers)
+	{
+		queryRect(AABB(point, point), results, layers);
+	}
+}
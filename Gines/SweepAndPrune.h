@@ -0,0 +1,48 @@
+#pragma once
+
+#include <vector>
+#include "Broadphase.h"
+
+namespace gines
+{
+	/*Sweep and prune broadphase along the x axis.
+	Bounds are kept in separate min/max arrays sorted by min x. They are re-sorted with insertion sort before each query,
+	which is close to linear when boxes move a little between frames. Suits scenes where most boxes move every frame*/
+	class SweepAndPrune : public Broadphase
+	{
+	public:
+		SweepAndPrune();
+		~SweepAndPrune();
+
+		void insert(CollisionBox* box);
+		void remove(CollisionBox* box);
+		void update(CollisionBox* box);
+		void clear();
+
+		void queryPairs(std::vector<CollisionPair>& pairs);
+		void queryRect(const AABB& rect, std::vector<CollisionBox*>& results, unsigned layers = GINES_ALL_LAYERS);
+		void queryPoint(glm::vec2 point, std::vector<CollisionBox*>& results, unsigned layers = GINES_ALL_LAYERS);
+
+	private:
+		void prepare();//Drops removed entries and sorts
+		void sort();
+		void swapEntries(unsigned a, unsigned b);
+		unsigned findEnd(float x);//First entry whose min x is past x
+
+		//Sorted by min x
+		std::vector<float> minX;
+		std::vector<float> minY;
+		std::vector<float> maxX;
+		std::vector<float> maxY;
+		std::vector<unsigned> layerBits;
+		std::vector<unsigned> maskBits;
+		std::vector<CollisionBox*> boxes;//nullptr for removed entries
+		std::vector<unsigned> ids;//Proxy id of each entry
+
+		std::vector<unsigned> dense;//Entry index of each proxy id
+		std::vector<unsigned> freeIds;
+		unsigned removedCount = 0;
+		unsigned insertedCount = 0;//Appended unsorted since the last sort
+		bool sorted = true;
+	};
+}
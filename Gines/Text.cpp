@@ -10,6 +10,7 @@
 #include "GameObject.h"
 #include "Transform.h"
 #include "Camera.h"
+#include "Profiler.h"
 //#include "Error.hpp"
 extern int WINDOW_WIDTH;
 extern int WINDOW_HEIGHT;
@@ -88,11 +89,12 @@ namespace gines
 		}
 	}
 	Text::Text() : gameObjectPosition(0, 0)
-	{//Default constructor is called from copy constructor as well
+	{//Default constructor
 		textCount++;
 	}
-	Text::Text(const Text& original)
+	Text::Text(const Text& original) : Component(original), gameObjectPosition(0, 0)
 	{//Copy constructor
+		textCount++;
 		glGenBuffers(1, &vertexArrayData);
 		string = original.string;
 		position = original.position;
@@ -352,6 +354,7 @@ namespace gines
 		//Submit data
 		glBindBuffer(GL_ARRAY_BUFFER, vertexArrayData);
 		glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(GLfloat) * 24 * glyphsToRender, vertices);
+		perfCounters.bufferBytes += sizeof(GLfloat) * 24 * glyphsToRender;
 		glBindBuffer(GL_ARRAY_BUFFER, 0);
 		delete[] vertices;
 		doUpdate = false;
@@ -386,11 +389,15 @@ namespace gines
 	{
 		cam->enableViewport();
 		if (gameObject != nullptr)
-			if (gameObjectPosition != gameObject->transform().getPosition())
+		{
+			unsigned version = gameObject->transform().getWorldVersion();
+			if (transformVersion != version)
 			{//Game object moved
-				gameObjectPosition = gameObject->transform().getPosition();
+				transformVersion = version;
+				gameObjectPosition = gameObject->transform().getWorldPosition();
 				doUpdate = true;
 			}
+		}
 
 		if (doUpdate)
 			updateBuffers();
@@ -413,6 +420,9 @@ namespace gines
 			glBindTexture(GL_TEXTURE_2D, textures[i]);
 			glDrawArrays(GL_TRIANGLES, i * 6, 6);
 		}
+		perfCounters.drawCalls += glyphsToRender;
+		perfCounters.textureBinds += glyphsToRender;
+		perfCounters.glyphs += glyphsToRender;
 
 		//Unbinds / unuse program
 		glDisableVertexAttribArray(0);
@@ -465,4 +475,8 @@ namespace gines
 	{
 		return string;
 	}
+	glm::vec2 Text::getPosition()
+	{
+		return position;
+	}
 }
\ No newline at end of file
@@ -53,6 +53,7 @@ namespace gines
 		bool setFont(char* fontPath, int size);
 		bool setFontSize(int size);
 		void render();
+		bool isThreadSafe(){ return true; }//No update
 		void setString(std::string str);
 		void setColor(glm::vec4& col);
 		void setColor(float r, float g, float b, float a = 1.0f);
@@ -68,6 +69,7 @@ namespace gines
 		glm::vec4& getColorRef();
 		int getGlyphsToRender();
 		std::string getString();
+		glm::vec2 getPosition();
 
 	private:
 		void renderToCamera(Camera* cam);
@@ -83,6 +85,7 @@ namespace gines
 		std::string string;
 		Font* font = nullptr;
 		void unreferenceFont();
-		glm::vec2 gameObjectPosition;//Game object position tracking
+		glm::vec2 gameObjectPosition;//World position of the game object
+		unsigned transformVersion = 0;//World transform version that gameObjectPosition was read from
 	};
 }
@@ -3,6 +3,7 @@
 
 #include "Time.h"
 #include "Text.h"
+#include "Gines.h"
 
 #define FPS_REFRESH_RATE 5
 
@@ -50,6 +51,9 @@ namespace gines
 			return false;
 		}
 
+		console.addVariable("maxFPS", maxFPS);
+		console.addVariable("showFps", showFps);
+
 		fpsCounter->useCameras(false);
 		fpsCounter->setColor(glm::vec4(0.12f, 0.45f, 0.07f, 1.0f));
 		fpsCounter->setPosition(glm::vec2(5, WINDOW_HEIGHT - fpsCounter->getFontHeight()));
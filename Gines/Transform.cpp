@@ -1,87 +1,263 @@
 #include "Transform.h"
+#include "GameObject.h"
+#include "Simd.h"
+#include <cmath>
+#include <mutex>
+#include <atomic>
 
 namespace gines
 {
+	//Moved this frame list
+	static bool movedTracking = false;
+	static std::vector<Transform*> movedTransforms;
+	static std::mutex movedMutex;//Transforms can be moved from update jobs
+
+	/*World versions of every transform come from one counter, so a transform that replaces a removed one
+	never repeats a version that a sprite or collision box still holds*/
+	static std::atomic<unsigned> worldVersionCounter;//Zero initialized, dependents start from 0 so that they update once
+	static unsigned nextWorldVersion()
+	{
+		return worldVersionCounter.fetch_add(1, std::memory_order_relaxed) + 1;
+	}
+
 	//TRANSFORM
 	Transform::Transform() :
-		position(0, 0), scale(0, 0), rotation(0)
+		position(0, 0), scale(1, 1), rotation(0), worldVersion(nextWorldVersion()), worldPosition(0, 0), worldScale(1, 1), worldMatrix(1.0f)
 	{}
+	Transform::Transform(const Transform& original) : MonoComponent(original),
+		position(original.position), scale(original.scale), rotation(original.rotation), worldVersion(nextWorldVersion()), worldPosition(0, 0), worldScale(1, 1), worldMatrix(1.0f)
+	{
+		if (original.store != nullptr)
+		{//Current values are in the store
+			position = original.store->getPosition(original.storeId);
+			rotation = original.store->getRotation(original.storeId);
+			scale = original.store->getScale(original.storeId);
+		}
+	}
+	Transform::~Transform() {
+		if (movedIndex != UINT_MAX) {
+			std::lock_guard<std::mutex> lock(movedMutex);
+			movedTransforms[movedIndex] = movedTransforms.back();
+			movedTransforms[movedIndex]->movedIndex = movedIndex;
+			movedTransforms.pop_back();
+		}
+		if (store != nullptr)
+			store->remove(storeId);
+	}
 
 	//Rotate object relative to current rotation using degrees
 	//Preferably use radians, as it is more efficient
 	void Transform::rotateDeg(float degree) {
 		float radian = degree * (M_PI / 180);
-		rotation += radian;
-		clampRotation(rotation);
+		writeRotation(getRotation() + radian);
 	}
 
 	//Set absolute rotation using degrees
 	//Preferably use radians, as it is more efficient
 	void Transform::setRotationDeg(float newDegree) {
 		float radian = newDegree * (M_PI / 180);
-		rotation = radian;
-		clampRotation(rotation);
+		writeRotation(radian);
 	}
 
 	//Rotate object relative to current rotation using radians
 	void Transform::rotate(float radian) {
-		rotation += radian;
-		clampRotation(rotation);
+		writeRotation(getRotation() + radian);
 	}
 
 	//Set absolute rotation using radians
 	void Transform::setRotation(float newRadian) {
-		rotation = newRadian;
-		clampRotation(rotation);
+		writeRotation(newRadian);
 	}
 
 	//Move object relative to current position
 	void Transform::move(glm::vec2& move) {
-		position += move;
+		writePosition(getPosition() + move);
 	}
 
 	void Transform::move(float x, float y) {
-		position.x += x;
-		position.y += y;
+		glm::vec2 newPosition = getPosition();
+		newPosition.x += x;
+		newPosition.y += y;
+		writePosition(newPosition);
 	}
 
 	//Set absolute position
 	void Transform::setPosition(glm::vec2& newPosition) {
-		position = newPosition;
+		writePosition(newPosition);
 	}
 
 	void Transform::setPosition(float x, float y) {
-		position = glm::vec2(x, y);
+		writePosition(glm::vec2(x, y));
 	}
 
 	//Non-Uniform scale
 	void Transform::setScale(glm::vec2& newScale) {
-		scale *= newScale;
+		writeScale(newScale);
 	}
 
 	void Transform::setScale(float x, float y) {
-		scale *= glm::vec2(x, y);
+		writeScale(glm::vec2(x, y));
 	}
 
 	//Uniform scale
 	void Transform::setScale(float newScale) {
-		scale *= glm::vec2(newScale, newScale);
+		writeScale(glm::vec2(newScale, newScale));
 	}
 
 	void Transform::clampRotation(float& rotation) {
-		while (rotation < 0 || rotation > 2 * M_PI)
-		{
-			if (rotation > 2 * M_PI) {
-				rotation -= 2 * M_PI;
-			}
-			if (rotation < 0) {
-				rotation += 2 * M_PI;
-			}
+		rotation = simd::wrapAngle(rotation);
+	}
+
+	//Local values go to the store when bound
+	void Transform::writePosition(glm::vec2 newPosition) {
+		if (store != nullptr)
+			store->setPosition(storeId, newPosition);//Marks this dirty
+		else {
+			position = newPosition;
+			markWorldDirty();
+		}
+	}
+	void Transform::writeRotation(float newRotation) {
+		if (store != nullptr)
+			store->setRotation(storeId, newRotation);
+		else {
+			rotation = newRotation;
+			clampRotation(rotation);
+			markWorldDirty();
+		}
+	}
+	void Transform::writeScale(glm::vec2 newScale) {
+		if (store != nullptr)
+			store->setScale(storeId, newScale);
+		else {
+			scale = newScale;
+			markWorldDirty();
+		}
+	}
+
+	//Store binding
+	void Transform::bindToStore(TransformStore& newStore) {
+		if (store == &newStore)
+			return;
+		glm::vec2 currentPosition = getPosition();
+		float currentRotation = getRotation();
+		glm::vec2 currentScale = getScale();
+		unbindFromStore();
+		storeId = newStore.add(currentPosition, currentRotation, currentScale);
+		newStore.owners[newStore.dense[storeId]] = this;
+		store = &newStore;
+	}
+	void Transform::unbindFromStore() {
+		if (store == nullptr)
+			return;
+		position = store->getPosition(storeId);
+		rotation = store->getRotation(storeId);
+		scale = store->getScale(storeId);
+		TransformStore* oldStore = store;
+		store = nullptr;
+		oldStore->owners[oldStore->dense[storeId]] = nullptr;
+		oldStore->remove(storeId);
+	}
+
+	//World transform
+	glm::vec2 Transform::getWorldPosition() {
+		if (worldDirty)
+			updateWorld();
+		return worldPosition;
+	}
+	glm::vec2 Transform::getWorldScale() {
+		if (worldDirty)
+			updateWorld();
+		return worldScale;
+	}
+	float Transform::getWorldRotation() {
+		if (worldDirty)
+			updateWorld();
+		return worldRotation;
+	}
+	glm::mat4 Transform::getWorldMatrix() {
+		if (worldDirty)
+			updateWorld();
+		return worldMatrix;
+	}
+	void Transform::markWorldDirty() {
+		worldVersion = nextWorldVersion();
+		if (movedTracking && movedIndex == UINT_MAX)
+			addToMovedList();
+		if (worldDirty)
+			return;//Children are already dirty
+		worldDirty = true;
+		if (gameObject != nullptr)
+			gameObject->markChildTransformsDirty();
+	}
+
+	void Transform::addToMovedList() {
+		std::lock_guard<std::mutex> lock(movedMutex);
+		if (movedIndex != UINT_MAX)
+			return;
+		movedIndex = movedTransforms.size();
+		movedTransforms.push_back(this);
+	}
+	void Transform::setMovedTracking(bool enabled) {
+		movedTracking = enabled;
+		if (!enabled)
+			clearMovedTransforms();
+	}
+	const std::vector<Transform*>& Transform::getMovedTransforms() {
+		return movedTransforms;
+	}
+	void Transform::clearMovedTransforms() {
+		std::lock_guard<std::mutex> lock(movedMutex);
+		for (unsigned i = 0; i < movedTransforms.size(); i++) {
+			movedTransforms[i]->movedIndex = UINT_MAX;
+		}
+		movedTransforms.clear();
+	}
+
+	Transform* Transform::getParentTransform() {
+		if (gameObject == nullptr)
+			return nullptr;
+		GameObject* object = gameObject->parent;
+		while (object != nullptr && object->transformComponent == nullptr) {
+			object = object->parent;
 		}
+		return object != nullptr ? object->transformComponent : nullptr;
 	}
 
-	void Transform::update() {
+	void Transform::updateWorld() {
+		Transform* parentTransform = getParentTransform();
+		glm::vec2 position = getPosition();
+		float rotation = getRotation();
+		glm::vec2 scale = getScale();
+		if (parentTransform != nullptr) {
+			if (parentTransform->worldDirty)
+				parentTransform->updateWorld();
+			//Local position is scaled and rotated by the parent
+			float c = std::cos(parentTransform->worldRotation);
+			float s = std::sin(parentTransform->worldRotation);
+			glm::vec2 local(position.x * parentTransform->worldScale.x, position.y * parentTransform->worldScale.y);
+			worldPosition.x = parentTransform->worldPosition.x + c * local.x - s * local.y;
+			worldPosition.y = parentTransform->worldPosition.y + s * local.x + c * local.y;
+			worldRotation = parentTransform->worldRotation + rotation;
+			clampRotation(worldRotation);
+			worldScale = glm::vec2(parentTransform->worldScale.x * scale.x, parentTransform->worldScale.y * scale.y);
+		}
+		else {
+			worldPosition = position;
+			worldRotation = rotation;
+			worldScale = scale;
+		}
+
+		float c = std::cos(worldRotation);
+		float s = std::sin(worldRotation);
+		worldMatrix = glm::mat4(1.0f);
+		worldMatrix[0][0] = c * worldScale.x;
+		worldMatrix[0][1] = s * worldScale.x;
+		worldMatrix[1][0] = -s * worldScale.y;
+		worldMatrix[1][1] = c * worldScale.y;
+		worldMatrix[3][0] = worldPosition.x;
+		worldMatrix[3][1] = worldPosition.y;
 
-		//std::cout << "\nTransform update()";
+		worldDirty = false;
 	}
 }
\ No newline at end of file
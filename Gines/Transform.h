@@ -1,8 +1,12 @@
 #pragma once
 
 #include <glm/vec2.hpp>
+#include <glm/glm.hpp>
 #include <iostream>
+#include <vector>
+#include <climits>
 #include "Component.h"
+#include "TransformStore.h"
 
 
 namespace gines
@@ -11,9 +15,10 @@ namespace gines
 	{
 	public:
 		Transform();
-		~Transform(){};
+		Transform(const Transform& original);//Copies local position, rotation and scale, not the store binding
+		~Transform();
 
-		void update();
+		bool isThreadSafe(){ return true; }
 
 		//Rotate object relative to current rotation
 		void rotateDeg(float degree);
@@ -43,15 +48,58 @@ namespace gines
 		void setScale(float newScale);
 
 
-		glm::vec2 getPosition() { return position; }
-		glm::vec2 getScale() { return scale; }
-		float getRotation() { return rotation; }
-		float getRotationDeg() { return rotation * (180 / M_PI); }
+		glm::vec2 getPosition() { return store == nullptr ? position : store->getPosition(storeId); }
+		glm::vec2 getScale() { return store == nullptr ? scale : store->getScale(storeId); }
+		float getRotation() { return store == nullptr ? rotation : store->getRotation(storeId); }
+		float getRotationDeg() { return getRotation() * (180 / M_PI); }
+
+		/*Moves position, rotation and scale into the store so that they can be processed in batches, see TransformStore.h.
+		Unbinding (or destroying the store) copies the values back to the transform*/
+		void bindToStore(TransformStore& newStore);
+		void unbindFromStore();
+		TransformStore* getStore(){ return store; }
+		unsigned getStoreId(){ return storeId; }
+
+		/*World space values combined from the parent chain (game objects without a transform are skipped).
+		Recomputed on first access after this transform or one of the parent transforms has changed*/
+		glm::vec2 getWorldPosition();
+		glm::vec2 getWorldScale();
+		float getWorldRotation();
+		glm::mat4 getWorldMatrix();
+		/*Changes every time this transform or one of the parent transforms changes, and is never repeated by another transform.
+		Store the value and compare it later to find out whether the object has moved, then read the world values.
+		Parent changes only reach this version again after the world values have been read*/
+		unsigned getWorldVersion(){ return worldVersion; }
+		//Bumps the version and marks this and the child transforms for world transform recomputation. Called by the setters and on reparenting
+		void markWorldDirty();
+
+		/*Transforms whose version changed during this frame, in the order they first changed.
+		Only collected while tracking is enabled, the list is cleared at the start of every frame by beginMainLoop()*/
+		static void setMovedTracking(bool enabled);
+		static const std::vector<Transform*>& getMovedTransforms();
+		static void clearMovedTransforms();
 
 	private:
 		void clampRotation(float& rotation);
+		void writePosition(glm::vec2 newPosition);
+		void writeRotation(float newRotation);
+		void writeScale(glm::vec2 newScale);
+		void updateWorld();
+		void addToMovedList();
+		Transform* getParentTransform();
 		glm::vec2 position;
 		glm::vec2 scale;
 		float rotation;
+		TransformStore* store = nullptr;//Position, rotation and scale are in the store instead when bound
+		unsigned storeId = 0;
+
+		//World transform cache. A dirty transform always has dirty children, so marking can stop at a dirty transform
+		bool worldDirty = true;
+		unsigned worldVersion;//From a counter shared by all transforms
+		unsigned movedIndex = UINT_MAX;//Position in the moved list, UINT_MAX when not in the list
+		glm::vec2 worldPosition;
+		glm::vec2 worldScale;
+		float worldRotation = 0.0f;
+		glm::mat4 worldMatrix;
 	};
 }
\ No newline at end of file
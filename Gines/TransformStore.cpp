@@ -0,0 +1,241 @@
+#include "TransformStore.h"
+#include "Transform.h"
+#include "Simd.h"
+#include <climits>
+#include <cmath>
+
+namespace gines
+{
+	TransformStore::TransformStore()
+	{
+	}
+	TransformStore::~TransformStore()
+	{
+		//Bound transforms take their values back. Backwards, so that removal only moves entries that were already visited
+		for (unsigned i = owners.size(); i-- > 0;)
+		{
+			if (owners[i] != nullptr)
+				owners[i]->unbindFromStore();
+		}
+	}
+
+	unsigned TransformStore::add(glm::vec2 position, float _rotation, glm::vec2 scale)
+	{
+		unsigned id;
+		if (freeIds.empty())
+		{
+			id = dense.size();
+			dense.push_back(0);
+		}
+		else
+		{
+			id = freeIds.back();
+			freeIds.pop_back();
+		}
+		dense[id] = x.size();
+		ids.push_back(id);
+		owners.push_back(nullptr);
+		x.push_back(position.x);
+		y.push_back(position.y);
+		rotation.push_back(simd::wrapAngle(_rotation));
+		scaleX.push_back(scale.x);
+		scaleY.push_back(scale.y);
+		velocityX.push_back(0.0f);
+		velocityY.push_back(0.0f);
+		angularVelocity.push_back(0.0f);
+		matrix00.push_back(1.0f);
+		matrix01.push_back(0.0f);
+		matrix10.push_back(0.0f);
+		matrix11.push_back(1.0f);
+		return id;
+	}
+	void TransformStore::remove(unsigned id)
+	{
+		if (!contains(id))
+			return;
+		//Move the last entry into the hole
+		unsigned index = dense[id];
+		unsigned last = x.size() - 1;
+		if (index != last)
+		{
+			x[index] = x[last];
+			y[index] = y[last];
+			rotation[index] = rotation[last];
+			scaleX[index] = scaleX[last];
+			scaleY[index] = scaleY[last];
+			velocityX[index] = velocityX[last];
+			velocityY[index] = velocityY[last];
+			angularVelocity[index] = angularVelocity[last];
+			matrix00[index] = matrix00[last];
+			matrix01[index] = matrix01[last];
+			matrix10[index] = matrix10[last];
+			matrix11[index] = matrix11[last];
+			owners[index] = owners[last];
+			ids[index] = ids[last];
+			dense[ids[index]] = index;
+		}
+		x.pop_back();
+		y.pop_back();
+		rotation.pop_back();
+		scaleX.pop_back();
+		scaleY.pop_back();
+		velocityX.pop_back();
+		velocityY.pop_back();
+		angularVelocity.pop_back();
+		matrix00.pop_back();
+		matrix01.pop_back();
+		matrix10.pop_back();
+		matrix11.pop_back();
+		owners.pop_back();
+		ids.pop_back();
+		dense[id] = UINT_MAX;
+		freeIds.push_back(id);
+	}
+	bool TransformStore::contains(unsigned id)
+	{
+		return id < dense.size() && dense[id] != UINT_MAX;
+	}
+	void TransformStore::reserve(unsigned count)
+	{
+		x.reserve(count);
+		y.reserve(count);
+		rotation.reserve(count);
+		scaleX.reserve(count);
+		scaleY.reserve(count);
+		velocityX.reserve(count);
+		velocityY.reserve(count);
+		angularVelocity.reserve(count);
+		matrix00.reserve(count);
+		matrix01.reserve(count);
+		matrix10.reserve(count);
+		matrix11.reserve(count);
+		owners.reserve(count);
+		ids.reserve(count);
+		dense.reserve(count);
+	}
+
+	void TransformStore::setPosition(unsigned id, glm::vec2 position)
+	{
+		unsigned i = dense[id];
+		x[i] = position.x;
+		y[i] = position.y;
+		if (owners[i] != nullptr)
+			owners[i]->markWorldDirty();
+	}
+	void TransformStore::setRotation(unsigned id, float _rotation)
+	{
+		unsigned i = dense[id];
+		rotation[i] = simd::wrapAngle(_rotation);
+		if (owners[i] != nullptr)
+			owners[i]->markWorldDirty();
+	}
+	void TransformStore::setScale(unsigned id, glm::vec2 scale)
+	{
+		unsigned i = dense[id];
+		scaleX[i] = scale.x;
+		scaleY[i] = scale.y;
+		if (owners[i] != nullptr)
+			owners[i]->markWorldDirty();
+	}
+	void TransformStore::setVelocity(unsigned id, glm::vec2 velocity)
+	{
+		unsigned i = dense[id];
+		velocityX[i] = velocity.x;
+		velocityY[i] = velocity.y;
+	}
+	void TransformStore::setAngularVelocity(unsigned id, float _angularVelocity)
+	{
+		angularVelocity[dense[id]] = _angularVelocity;
+	}
+	glm::mat4 TransformStore::getLocalMatrix(unsigned id)
+	{
+		unsigned i = dense[id];
+		glm::mat4 matrix(1.0f);
+		matrix[0][0] = matrix00[i];
+		matrix[0][1] = matrix01[i];
+		matrix[1][0] = matrix10[i];
+		matrix[1][1] = matrix11[i];
+		matrix[3][0] = x[i];
+		matrix[3][1] = y[i];
+		return matrix;
+	}
+
+	void TransformStore::integrate(float deltaTime)
+	{
+		const unsigned count = x.size();
+		unsigned i = 0;
+#ifdef GINES_SSE2
+		const __m128 dt = _mm_set1_ps(deltaTime);
+		for (; i + 4 <= count; i += 4)
+		{
+			_mm_storeu_ps(&x[i], _mm_add_ps(_mm_loadu_ps(&x[i]), _mm_mul_ps(_mm_loadu_ps(&velocityX[i]), dt)));
+			_mm_storeu_ps(&y[i], _mm_add_ps(_mm_loadu_ps(&y[i]), _mm_mul_ps(_mm_loadu_ps(&velocityY[i]), dt)));
+			__m128 r = _mm_add_ps(_mm_loadu_ps(&rotation[i]), _mm_mul_ps(_mm_loadu_ps(&angularVelocity[i]), dt));
+			_mm_storeu_ps(&rotation[i], simd::wrapAnglePs(r));
+		}
+#endif
+		for (; i < count; i++)
+		{
+			x[i] += velocityX[i] * deltaTime;
+			y[i] += velocityY[i] * deltaTime;
+			rotation[i] = simd::wrapAngle(rotation[i] + angularVelocity[i] * deltaTime);
+		}
+
+		//Bound transforms that moved need their world transforms recomputed
+		for (i = 0; i < count; i++)
+		{
+			if (owners[i] != nullptr && (velocityX[i] != 0.0f || velocityY[i] != 0.0f || angularVelocity[i] != 0.0f))
+				owners[i]->markWorldDirty();
+		}
+	}
+	void TransformStore::wrapRotations()
+	{
+		const unsigned count = x.size();
+		unsigned i = 0;
+#ifdef GINES_SSE2
+		for (; i + 4 <= count; i += 4)
+		{
+			_mm_storeu_ps(&rotation[i], simd::wrapAnglePs(_mm_loadu_ps(&rotation[i])));
+		}
+#endif
+		for (; i < count; i++)
+		{
+			rotation[i] = simd::wrapAngle(rotation[i]);
+		}
+	}
+	void TransformStore::computeLocalMatrices()
+	{
+		const unsigned count = x.size();
+		unsigned i = 0;
+#ifdef GINES_SSE2
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128 sine, cosine;
+			simd::sinCosPs(_mm_loadu_ps(&rotation[i]), sine, cosine);
+			__m128 sx = _mm_loadu_ps(&scaleX[i]);
+			__m128 sy = _mm_loadu_ps(&scaleY[i]);
+			_mm_storeu_ps(&matrix00[i], _mm_mul_ps(cosine, sx));
+			_mm_storeu_ps(&matrix01[i], _mm_mul_ps(sine, sx));
+			_mm_storeu_ps(&matrix10[i], _mm_sub_ps(_mm_setzero_ps(), _mm_mul_ps(sine, sy)));
+			_mm_storeu_ps(&matrix11[i], _mm_mul_ps(cosine, sy));
+		}
+#endif
+		for (; i < count; i++)
+		{
+			float sine, cosine;
+			simd::sinCos(rotation[i], sine, cosine);
+			matrix00[i] = cosine * scaleX[i];
+			matrix01[i] = sine * scaleX[i];
+			matrix10[i] = -sine * scaleY[i];
+			matrix11[i] = cosine * scaleY[i];
+		}
+	}
+	void TransformStore::markBoundTransformsDirty()
+	{
+		for (unsigned i = 0; i < owners.size(); i++)
+		{
+			if (owners[i] != nullptr)
+				owners[i]->markWorldDirty();
+		}
+	}
+}
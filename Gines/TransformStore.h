@@ -0,0 +1,86 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+
+/*
+Structure of arrays storage for positions, rotations and scales, processed in batches:
+
+	gines::TransformStore bullets;
+	unsigned id = bullets.add(glm::vec2(x, y));
+	bullets.setVelocity(id, glm::vec2(0, 500));
+	...
+	bullets.integrate(deltaTime);//All entries at once
+
+Transform components can be bound to a store with Transform::bindToStore, after which their position, rotation and scale live in the store.
+Ids are stable, entries are kept dense by moving the last entry into the hole left by remove.
+The store computes local matrices, relative to the parent. They are world matrices only for transforms without a parent transform,
+Transform::getWorldMatrix combines the parent chain.
+*/
+namespace gines
+{
+	class Transform;
+	class TransformStore
+	{
+	public:
+		TransformStore();
+		~TransformStore();
+
+		unsigned add(glm::vec2 position = glm::vec2(0, 0), float rotation = 0.0f, glm::vec2 scale = glm::vec2(1, 1));//Returns the id of the new entry
+		void remove(unsigned id);
+		bool contains(unsigned id);
+		void reserve(unsigned count);
+		unsigned getCount(){ return x.size(); }
+
+		glm::vec2 getPosition(unsigned id){ unsigned i = dense[id]; return glm::vec2(x[i], y[i]); }
+		float getRotation(unsigned id){ return rotation[dense[id]]; }
+		glm::vec2 getScale(unsigned id){ unsigned i = dense[id]; return glm::vec2(scaleX[i], scaleY[i]); }
+		glm::vec2 getVelocity(unsigned id){ unsigned i = dense[id]; return glm::vec2(velocityX[i], velocityY[i]); }
+		float getAngularVelocity(unsigned id){ return angularVelocity[dense[id]]; }
+		void setPosition(unsigned id, glm::vec2 position);
+		void setRotation(unsigned id, float rotation);
+		void setScale(unsigned id, glm::vec2 scale);
+		void setVelocity(unsigned id, glm::vec2 velocity);
+		void setAngularVelocity(unsigned id, float angularVelocity);
+		glm::mat4 getLocalMatrix(unsigned id);//Computed by computeLocalMatrices
+
+		//Batch kernels, SSE2 when available (see Simd.h)
+		void integrate(float deltaTime);//Position += velocity * deltaTime, rotation += angularVelocity * deltaTime and wraps rotations
+		void wrapRotations();//Wraps all rotations to [0, 2pi)
+		void computeLocalMatrices();//Rotation and scale of each entry, same results with and without SSE2
+
+		/*Raw arrays indexed by dense index [0, getCount()) for custom kernels.
+		Call markBoundTransformsDirty afterwards if bound transforms were moved*/
+		float* getX(){ return x.data(); }
+		float* getY(){ return y.data(); }
+		float* getRotations(){ return rotation.data(); }
+		float* getScaleX(){ return scaleX.data(); }
+		float* getScaleY(){ return scaleY.data(); }
+		void markBoundTransformsDirty();
+
+	private:
+		friend class Transform;
+		TransformStore(const TransformStore&);
+		void operator=(const TransformStore&);
+
+		//Components
+		std::vector<float> x;
+		std::vector<float> y;
+		std::vector<float> rotation;
+		std::vector<float> scaleX;
+		std::vector<float> scaleY;
+		std::vector<float> velocityX;
+		std::vector<float> velocityY;
+		std::vector<float> angularVelocity;
+		//Matrix columns, translation is x and y
+		std::vector<float> matrix00;
+		std::vector<float> matrix01;
+		std::vector<float> matrix10;
+		std::vector<float> matrix11;
+
+		std::vector<Transform*> owners;//Bound transform of each entry, or nullptr
+		std::vector<unsigned> ids;//Id of each dense entry
+		std::vector<unsigned> dense;//Dense index of each id
+		std::vector<unsigned> freeIds;
+	};
+}
@@ -0,0 +1,75 @@
+#include "World.h"
+
+namespace gines
+{
+	//ARCHETYPE
+	unsigned Archetype::allocateRow(GameObject* object)
+	{
+		unsigned row;
+		if (freeRows.empty())
+		{
+			row = objects.size();
+			objects.push_back(object);
+		}
+		else
+		{//Reuse a hole so that the columns don't grow
+			row = freeRows.back();
+			freeRows.pop_back();
+			objects[row] = object;
+		}
+		liveRows++;
+		return row;
+	}
+	void Archetype::releaseRow(unsigned row)
+	{
+		//Components of the row have already been destroyed by the game object
+		objects[row] = nullptr;
+		freeRows.push_back(row);
+		liveRows--;
+	}
+
+	//WORLD
+	World::World()
+	{
+	}
+	World::~World()
+	{
+		//Deleting an object can delete its children from other archetypes too, so liveness is checked per row
+		for (unsigned a = 0; a < archetypes.size(); a++)
+		{
+			for (unsigned row = 0; row < archetypes[a]->objects.size(); row++)
+			{
+				if (archetypes[a]->isAlive(row))
+				{
+					delete archetypes[a]->objects[row];
+				}
+			}
+		}
+		for (unsigned a = 0; a < archetypes.size(); a++)
+		{
+			delete archetypes[a];
+		}
+	}
+	unsigned World::getObjectCount()
+	{
+		unsigned count = 0;
+		for (unsigned a = 0; a < archetypes.size(); a++)
+		{
+			count += archetypes[a]->liveRows;
+		}
+		return count;
+	}
+	Archetype* World::getArchetype(unsigned signature)
+	{
+		//There are at most 16 archetypes, a linear search is enough
+		for (unsigned a = 0; a < archetypes.size(); a++)
+		{
+			if (archetypes[a]->signature == signature)
+			{
+				return archetypes[a];
+			}
+		}
+		archetypes.push_back(new Archetype(signature));
+		return archetypes.back();
+	}
+}
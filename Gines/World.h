@@ -0,0 +1,185 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <new>
+#include "GameObject.h"
+#include "Transform.h"
+#include "Sprite.h"
+#include "CollisionBox.h"
+#include "Camera.h"
+
+#define GINES_WORLD_CHUNK_SHIFT 8	//Rows per chunk = 2^shift
+#define GINES_WORLD_CHUNK_SIZE (1 << GINES_WORLD_CHUNK_SHIFT)
+
+/*
+///////////////////////////
+//  DATA ORIENTED WORLD  //
+///////////////////////////
+
+Opt-in storage for the core components (Transform, Sprite, CollisionBox, Camera).
+Game objects created by a World are grouped by the set of core components they have (archetype),
+and each archetype keeps those components in contiguous chunks instead of separate heap allocations.
+
+	gines::World world;
+	gines::GameObject* object = world.create<gines::Transform, gines::Sprite>("player");
+	object->getComponent<gines::Sprite>()->initialize(...);//The usual GameObject API still works
+
+	world.each<gines::Transform, gines::Sprite>([](gines::Transform& transform, gines::Sprite& sprite)
+	{
+		...
+	});
+
+The core components of a world object are fixed at creation and can not be removed individually,
+other components can be added and removed normally. Destroy world objects with delete as usual.
+*/
+namespace gines
+{
+	//Signature bit of each core component type
+	template <typename T> struct WorldComponent;
+	template <> struct WorldComponent<Transform> { static const unsigned bit = 1; };
+	template <> struct WorldComponent<Sprite> { static const unsigned bit = 2; };
+	template <> struct WorldComponent<CollisionBox> { static const unsigned bit = 4; };
+	template <> struct WorldComponent<Camera> { static const unsigned bit = 8; };
+
+	template <typename... Components> struct Signature;
+	template <> struct Signature<> { static const unsigned value = 0; };
+	template <typename T, typename... Components> struct Signature<T, Components...>
+	{
+		static const unsigned value = WorldComponent<T>::bit | Signature<Components...>::value;
+	};
+
+	/*Chunked array of T with stable addresses. Elements are constructed and destroyed explicitly per row*/
+	template <typename T>
+	class ComponentColumn
+	{
+	public:
+		ComponentColumn(){}
+		~ComponentColumn()
+		{
+			for (unsigned i = 0; i < chunks.size(); i++)
+			{
+				::operator delete(chunks[i]);
+			}
+		}
+		T& operator[](unsigned row)
+		{
+			return chunks[row >> GINES_WORLD_CHUNK_SHIFT][row & (GINES_WORLD_CHUNK_SIZE - 1)];
+		}
+		void reserve(unsigned rows)
+		{
+			while (chunks.size() * GINES_WORLD_CHUNK_SIZE < rows)
+			{
+				chunks.push_back(static_cast<T*>(::operator new(sizeof(T) * GINES_WORLD_CHUNK_SIZE)));
+			}
+		}
+		T* construct(unsigned row)
+		{
+			reserve(row + 1);
+			return new (&(*this)[row]) T();
+		}
+	private:
+		ComponentColumn(const ComponentColumn&);
+		void operator=(const ComponentColumn&);
+		std::vector<T*> chunks;
+	};
+
+	class Archetype
+	{
+	public:
+		Archetype(unsigned _signature) : signature(_signature){}
+
+		unsigned allocateRow(GameObject* object);
+		void releaseRow(unsigned row);
+		bool isAlive(unsigned row){ return objects[row] != nullptr; }
+
+		template <typename T>
+		ComponentColumn<T>& column();
+
+		const unsigned signature;
+		std::vector<GameObject*> objects;//Owner of each row, nullptr for free rows
+		std::vector<unsigned> freeRows;
+		unsigned liveRows = 0;
+
+	private:
+		ComponentColumn<Transform> transforms;
+		ComponentColumn<Sprite> sprites;
+		ComponentColumn<CollisionBox> collisionBoxes;
+		ComponentColumn<Camera> cameras;
+	};
+	template <> inline ComponentColumn<Transform>& Archetype::column<Transform>() { return transforms; }
+	template <> inline ComponentColumn<Sprite>& Archetype::column<Sprite>() { return sprites; }
+	template <> inline ComponentColumn<CollisionBox>& Archetype::column<CollisionBox>() { return collisionBoxes; }
+	template <> inline ComponentColumn<Camera>& Archetype::column<Camera>() { return cameras; }
+
+	class World
+	{
+	public:
+		World();
+		~World();//Destroys all game objects of the world
+
+		/*Creates a game object with the given core components stored in this world*/
+		template <typename... Components>
+		GameObject* create()
+		{
+			return attach<Components...>(new GameObject());
+		}
+		template <typename... Components>
+		GameObject* create(std::string name)
+		{
+			return attach<Components...>(new GameObject(name));
+		}
+
+		/*Calls fn(Components&...) for every world object that has all of the given core components*/
+		template <typename... Components, typename Function>
+		void each(Function fn)
+		{
+			const unsigned required = Signature<Components...>::value;
+			for (unsigned a = 0; a < archetypes.size(); a++)
+			{
+				Archetype* archetype = archetypes[a];
+				if ((archetype->signature & required) != required || archetype->liveRows == 0)
+					continue;
+				const unsigned rows = archetype->objects.size();
+				for (unsigned row = 0; row < rows; row++)
+				{
+					if (archetype->isAlive(row))
+					{
+						fn(archetype->column<Components>()[row]...);
+					}
+				}
+			}
+		}
+
+		unsigned getArchetypeCount(){ return archetypes.size(); }
+		unsigned getObjectCount();
+
+	private:
+		World(const World&);
+		void operator=(const World&);
+
+		template <typename... Components>
+		GameObject* attach(GameObject* object)
+		{
+			Archetype* archetype = getArchetype(Signature<Components...>::value);
+			unsigned row = archetype->allocateRow(object);
+			object->archetype = archetype;
+			object->archetypeRow = row;
+			int expand[] = { 0, (emplace<Components>(archetype, row, object), 0)... };
+			(void)expand;
+			return object;
+		}
+		template <typename T>
+		void emplace(Archetype* archetype, unsigned row, GameObject* object)
+		{
+			GameObject::registerComponentType<T>();
+			T* component = archetype->column<T>().construct(row);
+			component->worldStorage = true;
+			object->setTransformComponent(component, std::is_base_of<Transform, T>());
+			object->attachComponent(component, ComponentType<T>::id(), ComponentOverrides<T>::update, ComponentOverrides<T>::render);
+		}
+		Archetype* getArchetype(unsigned signature);
+
+		std::vector<Archetype*> archetypes;
+	};
+}